@@ -6,6 +6,7 @@
 #include "MoviePipelineQueue.h"
 #include "MoviePipelineOutputSetting.h"
 #include "MoviePipelineCustomEncoder.h"
+#include "MoviePipelineIntermediateFileCleanup.h"
 #include "LevelSequence.h"
 #include "MoviePipelineDeferredPasses.h"
 #include "MoviePipelineImageSequenceOutput.h"
@@ -13,8 +14,8 @@
 #include "ShaderCompiler.h"
 #include "HAL/IConsoleManager.h"
 #include "Misc/DefaultValueHelper.h"
-#include "HttpModule.h"
-#include "HttpManager.h"
+#include "OpenCueWorkerHttpClient.h"
+#include "OpenCueWorkerStatusChannel.h"
 #include "UObject/UnrealType.h"
 #include "Misc/ConfigCacheIni.h"
 
@@ -146,6 +147,11 @@ void UMoviePipelineOpenCueCmdExecutor::InitFromCommandLineParams()
 			InitParamsError = FString::Printf(TEXT("Invalid custom playback range: %d-%d (end < start)."), CustomStartFrame, CustomEndFrame);
 		}
 	}
+	else if (FParse::Param(FCommandLine::Get(), TEXT("EncodeAsChunk")))
+	{
+		bInitParamsValid = false;
+		InitParamsError = TEXT("-EncodeAsChunk requires -CustomStartFrame and -CustomEndFrame.");
+	}
 
 	switch (MovieQuality)
 	{
@@ -166,6 +172,16 @@ void UMoviePipelineOpenCueCmdExecutor::InitFromCommandLineParams()
 	}
 
 	FParse::Value(FCommandLine::Get(), TEXT("-MRQServerBaseUrl="), MRQServerBaseUrl);
+	FParse::Value(FCommandLine::Get(), TEXT("-IntermediateCleanupTimeout="), IntermediateCleanupTimeoutSec);
+	FParse::Value(FCommandLine::Get(), TEXT("-RetainFrames="), RetainFramesHours);
+	bEncodeAsChunk = FParse::Param(FCommandLine::Get(), TEXT("EncodeAsChunk"));
+	bFramesSubdir = FParse::Param(FCommandLine::Get(), TEXT("FramesSubdir"));
+
+	FString StatusChannelUrl;
+	if (FParse::Value(FCommandLine::Get(), TEXT("-StatusChannelUrl="), StatusChannelUrl))
+	{
+		FOpenCueWorkerStatusChannel::Connect(StatusChannelUrl, CurrentJobId);
+	}
 
 	// Initial delay frames: command-line override > project config > default (0)
 	if (!FParse::Value(FCommandLine::Get(), TEXT("-CmdInitialDelayFrames="), CmdInitialDelayFrameCount))
@@ -292,7 +308,9 @@ void UMoviePipelineOpenCueCmdExecutor::Execute_Implementation(UMoviePipelineQueu
 	OutputSetting->OutputDirectory.Path = RenderOutputPath;
 	OutputSetting->bUseCustomFrameRate = true;
 	OutputSetting->OutputFrameRate = RenderFrameRate;
-	OutputSetting->FileNameFormat = TEXT("{sequence_name}.{frame_number}");
+	// With -FramesSubdir intermediate frames go to their own sub directory so the encoder cleanup can remove it in
+	// one go, while the encoded video stays at the root of the output directory.
+	OutputSetting->FileNameFormat = bFramesSubdir ? TEXT("Frames/{sequence_name}.{frame_number}") : TEXT("{sequence_name}.{frame_number}");
 	UE_LOG(LogTemp, Log, TEXT("[OpenCueCmdExecutor] Output directory: %s"), *OutputSetting->OutputDirectory.Path);
 
 	if (bUseCustomPlaybackRange)
@@ -306,6 +324,20 @@ void UMoviePipelineOpenCueCmdExecutor::Execute_Implementation(UMoviePipelineQueu
 
 	CommandLineEncoder->Quality = static_cast<EMoviePipelineEncodeQuality>(MovieQuality);
 	CommandLineEncoder->bDeleteSourceFiles = true;
+	if (bEncodeAsChunk)
+	{
+		// The frame range is one chunk of a split render. Encode a fragment that the stitch task (-run=OpenCueStitch)
+		// can join with the neighbouring chunks without re-encoding.
+		CommandLineEncoder->bEncodeAsChunk = true;
+		FParse::Value(FCommandLine::Get(), TEXT("-ChunkGopSize="), CommandLineEncoder->ChunkGopSize);
+	}
+	if (RetainFramesHours > 0.f)
+	{
+		// Keep the frames for encode-only tasks (-run=OpenCueEncodeOnly) instead of deleting them after the encode.
+		CommandLineEncoder->bRetainSourceFrames = true;
+		CommandLineEncoder->SourceFrameRetentionHours = RetainFramesHours;
+	}
+	CommandLineEncoder->FileNameFormatOverride = TEXT("{sequence_name}");
 
 	// Add render passes
 	CurrentJob->GetConfiguration()->FindOrAddSettingByClass(UMoviePipelineDeferredPassBase::StaticClass());
@@ -602,20 +634,31 @@ void UMoviePipelineOpenCueCmdExecutor::OnBeginFrame_Implementation()
 	const FString InURL = FString::Printf(TEXT("%sue-notifications/job/%s/progress"), *MRQServerBaseUrl, *CurrentJobId);
 	const FString InVerb = TEXT("POST");
 	FString InMessage;
-	TMap<FString, FString> InHeaders;
-	InHeaders.Add(TEXT("Content-Type"), TEXT("application/json"));
+	// Progress is a snapshot, resending it after a dropped keep-alive connection is harmless and only the latest
+	// one needs to wait behind a slow server
+	FOpenCueHttpRequestOptions ProgressOptions;
+	ProgressOptions.bIdempotent = true;
+	ProgressOptions.bCoalesce = true;
 
 	FJsonObjectWrapper JsonWrapper;
 
+	// Over the status channel when it is up, REST otherwise
+	auto SendProgress = [&]()
+	{
+		if (!FOpenCueWorkerStatusChannel::SendProgress(CurrentJobId, JsonWrapper.JsonObject.ToSharedRef()))
+		{
+			JsonWrapper.JsonObjectToString(InMessage);
+			FOpenCueWorkerHttpClient::Send(InVerb, InURL, InMessage, FHttpRequestCompleteDelegate(), ProgressOptions);
+		}
+	};
+
 	switch (PipelineState)
 	{
 		case EMovieRenderPipelineState::Uninitialized:
 		{
 			JsonWrapper.JsonObject.Get()->SetStringField(TEXT("status"), GetStatusString(ERenderJobStatus::starting));
 			JsonWrapper.JsonObject.Get()->SetNumberField(TEXT("progress_percent"), 0.f);
-			JsonWrapper.JsonObjectToString(InMessage);
-
-			SendHTTPRequest(InURL, InVerb, InMessage, InHeaders);
+			SendProgress();
 			break;
 		}
 		case EMovieRenderPipelineState::ProducingFrames:
@@ -643,8 +686,7 @@ void UMoviePipelineOpenCueCmdExecutor::OnBeginFrame_Implementation()
 					JsonWrapper.JsonObject.Get()->SetNumberField(TEXT("progress_eta_seconds"), -1);
 				}
 
-				JsonWrapper.JsonObjectToString(InMessage);
-				SendHTTPRequest(InURL, InVerb, InMessage, InHeaders);
+				SendProgress();
 
 				LastProgressReportTime = CurrentTime;
 				LastReportedProgress = CompletionPercentage;
@@ -658,9 +700,7 @@ void UMoviePipelineOpenCueCmdExecutor::OnBeginFrame_Implementation()
 			{
 				JsonWrapper.JsonObject.Get()->SetStringField(TEXT("status"), GetStatusString(ERenderJobStatus::encoding));
 				JsonWrapper.JsonObject.Get()->SetNumberField(TEXT("progress_percent"), 1.f);
-				JsonWrapper.JsonObjectToString(InMessage);
-
-				SendHTTPRequest(InURL, InVerb, InMessage, InHeaders);
+				SendProgress();
 
 				LastProgressReportTime = FPlatformTime::Seconds();
 				LastReportedProgress = 1.f;
@@ -705,8 +745,18 @@ void UMoviePipelineOpenCueCmdExecutor::OnBeginFrame_Implementation()
 				JsonWrapper.JsonObject.Get()->SetNumberField(TEXT("progress_percent"), TotalProgress);
 				JsonWrapper.JsonObject.Get()->SetNumberField(TEXT("progress_eta_seconds"), ProgressEtaSeconds);
 
-				JsonWrapper.JsonObjectToString(InMessage);
-				SendHTTPRequest(InURL, InVerb, InMessage, InHeaders);
+				FMoviePipelineEncoderProgress EncoderProgress;
+				if (CommandLineEncoder && CommandLineEncoder->GetEncoderProgress(EncoderProgress))
+				{
+					JsonWrapper.JsonObject.Get()->SetNumberField(TEXT("encode_fps"), EncoderProgress.Fps);
+					JsonWrapper.JsonObject.Get()->SetNumberField(TEXT("encode_speed"), EncoderProgress.Speed);
+					if (EncoderProgress.Preset.Len() > 0)
+					{
+						JsonWrapper.JsonObject.Get()->SetStringField(TEXT("encode_preset"), EncoderProgress.Preset);
+					}
+				}
+
+				SendProgress();
 
 				LastProgressReportTime = CurrentTime;
 				LastReportedProgress = TotalProgress;
@@ -796,12 +846,17 @@ void UMoviePipelineOpenCueCmdExecutor::SendHttpOnMoviePipelineWorkFinished(
 	JsonObjectWrapper.JsonObject.Get()->SetStringField(TEXT("video_directory"), VideoOutputDir);
 	JsonObjectWrapper.JsonObjectToString(InMessage);
 
-	TMap<FString, FString> InHeaders;
-	InHeaders.Add(TEXT("Content-Type"), TEXT("application/json"));
-	SendHTTPRequest(InURL, InVerb, InMessage, InHeaders);
+	FOpenCueWorkerStatusChannel::SendState(CurrentJobId, bSuccess ? TEXT("completed") : TEXT("failed"));
+	// Ahead of any queued progress so the flush below does not run out of time before it goes out. The server keys on
+	// the job id, a resend after a reset connection is harmless
+	FOpenCueHttpRequestOptions RenderCompleteOptions;
+	RenderCompleteOptions.bIdempotent = true;
+	RenderCompleteOptions.bSendFirst = true;
+	FOpenCueWorkerHttpClient::Send(InVerb, InURL, InMessage, FHttpRequestCompleteDelegate(), RenderCompleteOptions);
 
 	// Block and wait for HTTP to complete before engine exits
-	FHttpModule::Get().GetHttpManager().Flush(EHttpFlushReason::FullFlush);
+	FOpenCueWorkerHttpClient::Flush(HttpFlushTimeoutSec);
+	FOpenCueWorkerStatusChannel::Disconnect();
 
 	UE_LOG(LogTemp, Log, TEXT("[OpenCueCmdExecutor] HTTP notification sent. VideoDir: %s"), *VideoOutputDir);
 }
@@ -815,6 +870,10 @@ void UMoviePipelineOpenCueCmdExecutor::RequestEngineExit(bool bSuccess)
 	UE_LOG(LogTemp, Log, TEXT("[OpenCueCmdExecutor] Requesting engine exit with code: %d (%s)"),
 		ExitCode, bSuccess ? TEXT("SUCCESS") : TEXT("FAILURE"));
 
+	// Intermediate frames are deleted on background tasks; give them a bounded amount of time to finish
+	// so we neither leave frames behind on a healthy share nor hang forever on a broken one.
+	FMoviePipelineIntermediateFileCleanup::WaitForPendingDeletes(IntermediateCleanupTimeoutSec);
+
 	FPlatformMisc::RequestExitWithStatus(true, ExitCode);
 }
 
@@ -41,8 +41,16 @@ enum class ERenderJobStatus : uint8
  *   -ShotName=<name>           : Optional shot name to render (disables other shots)
  *   -CustomStartFrame=<int>    : Optional playback range start frame (continuous only)
  *   -CustomEndFrame=<int>      : Optional playback range end frame (continuous only)
+ *   -EncodeAsChunk             : Optional, with a custom range: encode a chunk fragment for -run=OpenCueStitch instead of
+ *                                a standalone video. Chunks name their last frame, the next chunk starts at end + 1
+ *   -ChunkGopSize=<frames>     : Optional keyframe interval of chunk fragments, same for all chunks of a job (default 1s)
  *   -CmdInitialDelayFrames=<N> : Optional frames to wait before pipeline init (scene load/streaming)
  *   -MRQServerBaseUrl=<url>    : Optional HTTP server for progress notifications
+ *   -IntermediateCleanupTimeout=<sec> : Optional max wait for background deletion of intermediate frames on exit (default 60)
+ *   -RetainFrames=<hours>      : Optional, keep the rendered frames for re-encoding with -run=OpenCueEncodeOnly for this long
+ *   -FramesSubdir              : Optional, write frames to <output dir>/Frames/ instead of next to the video, so their
+ *                                cleanup removes one directory instead of deleting every frame
+ *   -StatusChannelUrl=<ws url> : Optional WebSocket for delta encoded progress records, REST is used while it is down
  *
  * Usage:
  *   UnrealEditor-Cmd.exe <project> <map> -game
@@ -123,6 +131,18 @@ private:
 	int32 CmdInitialDelayFrameCount = 0;
 	int32 RemainingInitializationFrames = -1;
 
+	// Max seconds to wait on exit for intermediate frame deletion running in the background
+	float IntermediateCleanupTimeoutSec = 60.f;
+
+	// Max seconds to block for the render-complete notification before exiting
+	float HttpFlushTimeoutSec = 30.f;
+
+	// Hours to keep the rendered frames for encode-only tasks, 0 deletes them after the encode
+	float RetainFramesHours = 0.f;
+	bool bEncodeAsChunk = false;
+	// Frames go to a Frames/ sub directory of the output directory (-FramesSubdir)
+	bool bFramesSubdir = false;
+
 	// Init/validation
 	bool bInitParamsValid = true;
 	FString InitParamsError;
@@ -28,6 +28,7 @@ public class OpenCueForUnrealEditor : ModuleRules
                 "Json",
                 "JsonUtilities",
                 "HTTP",
+                "HTTPServer",
                 "LevelSequence",
                 "MovieScene",
                 "MovieSceneTracks",
@@ -10,13 +10,17 @@
 #include "MoviePipelineGameOverrideSetting.h"
 #include "LevelSequence.h"
 #include "Engine/Engine.h"
+#include "Editor.h"
 #include "Kismet/GameplayStatics.h"
-#include "HttpModule.h"
-#include "HttpManager.h"
+#include "Interfaces/IHttpResponse.h"
+#include "OpenCueWorkerHttpClient.h"
+#include "OpenCueWorkerStatusChannel.h"
 #include "Dom/JsonObject.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
 #include "MoviePipelineCustomEncoder.h"
+#include "MoviePipelineIntermediateFileCleanup.h"
+#include "MoviePipelinePrimaryConfig.h"
 
 #define LOCTEXT_NAMESPACE "MoviePipelineOpenCuePIEExecutor"
 
@@ -58,6 +62,15 @@ void UMoviePipelineOpenCuePIEExecutor::InitializeWorker()
 	FParse::Value(FCommandLine::Get(), TEXT("-WorkerId="), WorkerId);
 	FParse::Value(FCommandLine::Get(), TEXT("-WorkerPoolBaseUrl="), WorkerPoolBaseUrl);
 	FParse::Value(FCommandLine::Get(), TEXT("-MRQServerBaseUrl="), MRQServerBaseUrl);
+	// Only a pool worker gets another job on the same map, an interactive render should end its session as usual
+	bKeepWorldWarm = bWorkerMode && !FParse::Param(FCommandLine::Get(), TEXT("NoWarmWorld"));
+	FParse::Value(FCommandLine::Get(), TEXT("-WarmWorldIdleTimeout="), WarmWorldIdleTimeoutSec);
+
+	FString StatusChannelUrl;
+	if (FParse::Value(FCommandLine::Get(), TEXT("-StatusChannelUrl="), StatusChannelUrl))
+	{
+		FOpenCueWorkerStatusChannel::Connect(StatusChannelUrl, WorkerId);
+	}
 
 	// Ensure URLs end with /
 	if (!WorkerPoolBaseUrl.EndsWith(TEXT("/")))
@@ -78,6 +91,14 @@ void UMoviePipelineOpenCuePIEExecutor::Execute_Implementation(UMoviePipelineQueu
 	UE_LOG(LogTemp, Log, TEXT("%s: Execute_Implementation called"), ANSI_TO_TCHAR(__FUNCTION__));
 
 	InitializeWorker();
+
+	if (InPipelineQueue && InPipelineQueue->GetJobs().Num() > 0)
+	{
+		// The job was leased by UOpenCueWorkerSubsystem, which owns the lease protocol; just render it
+		Super::Execute_Implementation(InPipelineQueue);
+		return;
+	}
+
 	HTTPResponseRecievedDelegate.AddUniqueDynamic(this, &UMoviePipelineOpenCuePIEExecutor::OnReceiveJobInfo);
 	StartWorkerLoop();
 	
@@ -85,11 +106,149 @@ void UMoviePipelineOpenCuePIEExecutor::Execute_Implementation(UMoviePipelineQueu
 
 bool UMoviePipelineOpenCuePIEExecutor::IsRendering_Implementation() const
 {
-	return bIsRendering || bWorkerRunning;
+	return bIsRendering || bWorkerRunning || Super::IsRendering_Implementation();
+}
+
+bool UMoviePipelineOpenCuePIEExecutor::RenderInWarmWorld(UMoviePipelineExecutorJob* InJob)
+{
+	UWorld* World = FindGameWorld();
+	if (!bWarmWorldIdle || !World || !InJob)
+	{
+		return false;
+	}
+
+	// PIE duplicates the map into a UEDPIE_<n>_ prefixed package
+	const FString WorldPackageName = UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+	if (WorldPackageName != InJob->Map.GetLongPackageName())
+	{
+		UE_LOG(LogTemp, Log, TEXT("[OpenCue] Warm world %s does not match job map %s"), *WorldPackageName, *InJob->Map.ToString());
+		return false;
+	}
+
+	// Same pipeline class the PIE executor created for the first job in this world
+	UClass* PipelineClass = ActiveMoviePipeline ? ActiveMoviePipeline->GetClass() : UMoviePipeline::StaticClass();
+	UMoviePipeline* NewPipeline = NewObject<UMoviePipeline>(World, PipelineClass);
+
+	bWarmWorldIdle = false;
+	++WarmWorldJobCount;
+	ActiveMoviePipeline = NewPipeline;
+	WarmWorldWatchedPipeline = NewPipeline;
+	WarmWorldPipeline = NewPipeline;
+	NewPipeline->OnMoviePipelineWorkFinished().AddUObject(this, &UMoviePipelineOpenCuePIEExecutor::OnWarmWorldPipelineFinished);
+
+	UE_LOG(LogTemp, Log, TEXT("[OpenCue] Rendering %s in warm world %s (job %d in this world)"), *InJob->JobName, *WorldPackageName, WarmWorldJobCount + 1);
+	BeginLeasedJob(InJob);
+	NewPipeline->Initialize(InJob);
+	return true;
+}
+
+void UMoviePipelineOpenCuePIEExecutor::ReleaseWarmWorld()
+{
+	if (!bWarmWorldIdle)
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("[OpenCue] Releasing warm world after %d job(s)"), WarmWorldJobCount + 1);
+	bWarmWorldIdle = false;
+	bReleasingWarmWorld = true;
+
+	// The PIE executor finishes its queue once the session has ended
+	if (GEditor)
+	{
+		GEditor->RequestEndPlayMap();
+	}
+}
+
+void UMoviePipelineOpenCuePIEExecutor::TickWarmWorld()
+{
+	// Watch the pipeline the PIE executor created so we see it finish
+	UMoviePipeline* Pipeline = Cast<UMoviePipeline>(ActiveMoviePipeline);
+	if (Pipeline && Pipeline != WarmWorldWatchedPipeline.Get())
+	{
+		WarmWorldWatchedPipeline = Pipeline;
+		Pipeline->OnMoviePipelineWorkFinished().AddUObject(this, &UMoviePipelineOpenCuePIEExecutor::OnWarmWorldPipelineFinished);
+	}
+
+	if (!bWarmWorldIdle)
+	{
+		return;
+	}
+
+	// The PIE executor requests end of play when its pipeline finishes; keep the session until we release it
+	if (GEditor && GEditor->ShouldEndPlayMap())
+	{
+		GEditor->CancelRequestEndPlayMap();
+	}
+
+	if (FPlatformTime::Seconds() - WarmWorldIdleStartTime >= WarmWorldIdleTimeoutSec)
+	{
+		ReleaseWarmWorld();
+	}
+}
+
+void UMoviePipelineOpenCuePIEExecutor::OnWarmWorldPipelineFinished(FMoviePipelineOutputData OutputData)
+{
+	// The PIE executor only reports the pipeline it created itself, report the ones we started in the warm world
+	const bool bStartedInWarmWorld = OutputData.Pipeline && OutputData.Pipeline == WarmWorldPipeline.Get();
+	if (bStartedInWarmWorld)
+	{
+		WarmWorldPipeline.Reset();
+		OnIndividualJobWorkFinished().Broadcast(OutputData);
+	}
+
+	// The next job of our own queue needs the session to end so the executor can load its map
+	const bool bQueueHasMoreJobs = Queue && CurrentPipelineIndex + 1 < Queue->GetJobs().Num();
+	if (!bKeepWorldWarm || !bWorkerMode || bQueueHasMoreJobs || bReleasingWarmWorld || !FindGameWorld())
+	{
+		return;
+	}
+
+	if (!bStartedInWarmWorld)
+	{
+		// The PIE executor reports its own pipeline only once the session ends, which we are holding off now.
+		// Remember the job so its second report at release is swallowed by OnIndividualJobFinishedImpl.
+		WarmWorldReportedJob = OutputData.Job;
+		OnIndividualJobWorkFinished().Broadcast(OutputData);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("[OpenCue] Pipeline finished (%s), keeping world warm for up to %.0fs"),
+		OutputData.bSuccess ? TEXT("Success") : TEXT("Failed"), WarmWorldIdleTimeoutSec);
+
+	bWarmWorldIdle = true;
+	WarmWorldIdleStartTime = FPlatformTime::Seconds();
+}
+
+void UMoviePipelineOpenCuePIEExecutor::OnIndividualJobFinishedImpl(FMoviePipelineOutputData InOutputData)
+{
+	if (InOutputData.Job && InOutputData.Job == WarmWorldReportedJob.Get())
+	{
+		WarmWorldReportedJob.Reset();
+		return;
+	}
+
+	Super::OnIndividualJobFinishedImpl(InOutputData);
+}
+
+bool UMoviePipelineOpenCuePIEExecutor::IsActivePipelineFinishing() const
+{
+	const UMoviePipeline* Pipeline = Cast<UMoviePipeline>(ActiveMoviePipeline);
+	if (!Pipeline)
+	{
+		return false;
+	}
+
+	const EMovieRenderPipelineState PipelineState = UMoviePipelineBlueprintLibrary::GetPipelineState(Pipeline);
+	return PipelineState == EMovieRenderPipelineState::Finalize || PipelineState == EMovieRenderPipelineState::Export;
 }
 
 void UMoviePipelineOpenCuePIEExecutor::OnBeginFrame_Implementation()
 {
+	if (bKeepWorldWarm)
+	{
+		TickWarmWorld();
+	}
+
 	if (!bIsRendering || !ActiveMoviePipeline)
 	{
 		return;
@@ -132,8 +291,29 @@ void UMoviePipelineOpenCuePIEExecutor::OnBeginFrame_Implementation()
 
 	case EMovieRenderPipelineState::Export:
 	{
-		// Still encoding - could extract more detailed progress here
-		// For now, report as encoding in progress
+		// Encoding - progress is 1.0 to 2.0, driven by the encoder's structured progress stream
+		const double CurrentTime = FPlatformTime::Seconds();
+		if (CurrentTime - LastProgressReportTime < ProgressReportIntervalSec)
+		{
+			break;
+		}
+
+		UMoviePipeline* Pipeline = Cast<UMoviePipeline>(ActiveMoviePipeline);
+		const UMoviePipelineCustomEncoder* Encoder = Pipeline ? Pipeline->GetPipelinePrimaryConfig()->FindSetting<UMoviePipelineCustomEncoder>() : nullptr;
+
+		FMoviePipelineEncoderProgress EncoderProgress;
+		if (Encoder && Encoder->GetEncoderProgress(EncoderProgress))
+		{
+			const float EncodeCompletion = EncoderProgress.GetCompletion();
+			int32 EtaSeconds = -1;
+			if (EncoderProgress.Fps > SMALL_NUMBER && EncoderProgress.ExpectedFrameCount > 0)
+			{
+				EtaSeconds = FMath::CeilToInt32(FMath::Max(EncoderProgress.ExpectedFrameCount - EncoderProgress.Frame, 0) / EncoderProgress.Fps);
+			}
+
+			ReportProgress(1.0f + FMath::Max(EncodeCompletion, 0.0f), EtaSeconds, &EncoderProgress);
+			LastProgressReportTime = CurrentTime;
+		}
 		break;
 	}
 
@@ -165,14 +345,48 @@ void UMoviePipelineOpenCuePIEExecutor::Start(const UMoviePipelineExecutorJob* In
 		// Mark job as "rendering" early to avoid repeated leases on "starting".
 		//SendJobProgress(TEXT("rendering"), 0.f, -1);
 	}
+
+	if (!bWorkerRunning)
+	{
+		BeginLeasedJob(InJob);
+	}
 	
 	Super::Start(InJob);
 	
 }
 
+void UMoviePipelineOpenCuePIEExecutor::BeginLeasedJob(const UMoviePipelineExecutorJob* InJob)
+{
+	if (!InJob)
+	{
+		return;
+	}
+
+	// Only the job id is known here; done and render-complete of leased jobs are sent by UOpenCueWorkerSubsystem
+	CurrentTask = FOpenCueTaskInfo();
+	CurrentTask.JobId = InJob->UserData.Len() > 0 ? InJob->UserData : InJob->JobName;
+	CurrentTask.LevelSequencePath = InJob->Sequence.ToString();
+	bIsRendering = true;
+	LastProgressReportTime = 0.0;
+	LastReportedProgress = -1.0f;
+
+	ReportProgress(0.0f, -1);
+}
+
 void UMoviePipelineOpenCuePIEExecutor::HandleIndividualJobFinished(FMoviePipelineOutputData OutputData)
 {
-	
+	// Jobs of the own worker loop are completed by OnMoviePipelineFinished
+	if (bWorkerRunning || !OutputData.Job)
+	{
+		return;
+	}
+
+	const FString JobId = OutputData.Job->UserData.Len() > 0 ? OutputData.Job->UserData : OutputData.Job->JobName;
+	if (JobId == CurrentTask.JobId)
+	{
+		bIsRendering = false;
+		CurrentTask = FOpenCueTaskInfo();
+	}
 }
 
 void UMoviePipelineOpenCuePIEExecutor::OnReceiveJobInfo(int32 RequestIndex, int32 ResponseCode, const FString& Message)
@@ -236,6 +450,12 @@ void UMoviePipelineOpenCuePIEExecutor::StopWorker()
 		HeartbeatTickerHandle.Reset();
 	}
 
+	if (CompletionTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(CompletionTickerHandle);
+		CompletionTickerHandle.Reset();
+	}
+
 	// Cleanup any active render
 	CleanupRenderTask();
 
@@ -275,14 +495,13 @@ void UMoviePipelineOpenCuePIEExecutor::PollForLease()
 {
 	const FString Url = FString::Printf(TEXT("%sworkers/%s/lease"), *WorkerPoolBaseUrl, *WorkerId);
 
-	TMap<FString, FString> Headers;
-	Headers.Add(TEXT("Content-Type"), TEXT("application/json"));
-
 	UE_LOG(LogTemp, Verbose, TEXT("[OpenCue] Polling for lease: %s"), *Url);
 
-	// SendHTTPRequest is inherited from UMoviePipelineLinearExecutorBase
-	int32 RequestIndex = SendHTTPRequest(Url, TEXT("GET"), TEXT(""), Headers);
-	// Note: Response will be handled asynchronously - you may need to bind to HTTP response delegate
+	FOpenCueWorkerHttpClient::Send(TEXT("GET"), Url, FString(), FHttpRequestCompleteDelegate::CreateWeakLambda(this,
+		[this](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			OnLeaseResponse(INDEX_NONE, Response.IsValid() ? Response->GetResponseCode() : 0, Response.IsValid() ? Response->GetContentAsString() : FString());
+		}));
 }
 
 void UMoviePipelineOpenCuePIEExecutor::SendHeartbeat()
@@ -304,12 +523,15 @@ void UMoviePipelineOpenCuePIEExecutor::SendHeartbeat()
 	FString Message;
 	JsonWrapper.JsonObjectToString(Message);
 
-	TMap<FString, FString> Headers;
-	Headers.Add(TEXT("Content-Type"), TEXT("application/json"));
-
 	UE_LOG(LogTemp, Verbose, TEXT("[OpenCue] Sending heartbeat: %s"), *GetStatusString(CurrentTaskStatus));
 
-	SendHTTPRequest(Url, TEXT("POST"), Message, Headers);
+	FOpenCueHttpRequestOptions Options;
+	Options.bIdempotent = true;
+	FOpenCueWorkerHttpClient::Send(TEXT("POST"), Url, Message, FHttpRequestCompleteDelegate::CreateWeakLambda(this,
+		[this](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			OnHeartbeatResponse(INDEX_NONE, Response.IsValid() ? Response->GetResponseCode() : 0, Response.IsValid() ? Response->GetContentAsString() : FString());
+		}), Options);
 }
 
 void UMoviePipelineOpenCuePIEExecutor::NotifyTaskDone(bool bSuccess)
@@ -328,21 +550,21 @@ void UMoviePipelineOpenCuePIEExecutor::NotifyTaskDone(bool bSuccess)
 	FString Message;
 	JsonWrapper.JsonObjectToString(Message);
 
-	TMap<FString, FString> Headers;
-	Headers.Add(TEXT("Content-Type"), TEXT("application/json"));
+	UE_LOG(LogTemp, Log, TEXT("[OpenCue] Notifying task done: %s, success: %s (attempt %d)"),
+		*CurrentTask.TaskId, bSuccess ? TEXT("true") : TEXT("false"), TaskDoneAck.Attempts + 1);
 
-	UE_LOG(LogTemp, Log, TEXT("[OpenCue] Notifying task done: %s, success: %s"),
-		*CurrentTask.TaskId, bSuccess ? TEXT("true") : TEXT("false"));
-
-	SendHTTPRequest(Url, TEXT("POST"), Message, Headers);
-
-	// Flush to ensure the request is sent before we continue
-	FHttpModule::Get().GetHttpManager().Flush(EHttpFlushReason::FullFlush);
+	// Acknowledged asynchronously, TickCompletion retries until it is or the completion times out
+	TaskDoneAck.OnSent(FPlatformTime::Seconds());
+	FOpenCueWorkerHttpClient::Send(TEXT("POST"), Url, Message, FHttpRequestCompleteDelegate::CreateWeakLambda(this,
+		[this](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			OnTaskDoneResponse(INDEX_NONE, Response.IsValid() ? Response->GetResponseCode() : 0, Response.IsValid() ? Response->GetContentAsString() : FString());
+		}));
 }
 
-void UMoviePipelineOpenCuePIEExecutor::ReportProgress(float Progress, int32 EtaSeconds)
+void UMoviePipelineOpenCuePIEExecutor::ReportProgress(float Progress, int32 EtaSeconds, const FMoviePipelineEncoderProgress* EncoderProgress)
 {
-	if (!CurrentTask.IsValid())
+	if (CurrentTask.JobId.IsEmpty())
 	{
 		return;
 	}
@@ -354,21 +576,36 @@ void UMoviePipelineOpenCuePIEExecutor::ReportProgress(float Progress, int32 EtaS
 	JsonWrapper.JsonObject->SetStringField(TEXT("status"), bIsRendering ? TEXT("rendering") : TEXT("encoding"));
 	JsonWrapper.JsonObject->SetNumberField(TEXT("progress_percent"), Progress);
 	JsonWrapper.JsonObject->SetNumberField(TEXT("progress_eta_seconds"), EtaSeconds);
+	if (EncoderProgress)
+	{
+		JsonWrapper.JsonObject->SetNumberField(TEXT("encode_fps"), EncoderProgress->Fps);
+		JsonWrapper.JsonObject->SetNumberField(TEXT("encode_speed"), EncoderProgress->Speed);
+		if (EncoderProgress->Preset.Len() > 0)
+		{
+			JsonWrapper.JsonObject->SetStringField(TEXT("encode_preset"), EncoderProgress->Preset);
+		}
+	}
 
 	FString Message;
 	JsonWrapper.JsonObjectToString(Message);
 
-	TMap<FString, FString> Headers;
-	Headers.Add(TEXT("Content-Type"), TEXT("application/json"));
-
 	UE_LOG(LogTemp, Log, TEXT("[OpenCue] Progress: %.1f%%, ETA: %d sec"), Progress * 100.f, EtaSeconds);
 
-	SendHTTPRequest(Url, TEXT("POST"), Message, Headers);
+	if (FOpenCueWorkerStatusChannel::SendProgress(CurrentTask.JobId, JsonWrapper.JsonObject.ToSharedRef()))
+	{
+		return;
+	}
+
+	// Progress is a snapshot, resending it is harmless and only the latest one needs to wait behind a slow server
+	FOpenCueHttpRequestOptions Options;
+	Options.bIdempotent = true;
+	Options.bCoalesce = true;
+	FOpenCueWorkerHttpClient::Send(TEXT("POST"), Url, Message, FHttpRequestCompleteDelegate(), Options);
 }
 
 void UMoviePipelineOpenCuePIEExecutor::ReportRenderComplete(bool bSuccess, const FString& VideoDirectory)
 {
-	if (!CurrentTask.IsValid())
+	if (CurrentTask.JobId.IsEmpty())
 	{
 		return;
 	}
@@ -383,16 +620,20 @@ void UMoviePipelineOpenCuePIEExecutor::ReportRenderComplete(bool bSuccess, const
 	FString Message;
 	JsonWrapper.JsonObjectToString(Message);
 
-	TMap<FString, FString> Headers;
-	Headers.Add(TEXT("Content-Type"), TEXT("application/json"));
-
-	UE_LOG(LogTemp, Log, TEXT("[OpenCue] Render complete: success=%s, dir=%s"),
-		bSuccess ? TEXT("true") : TEXT("false"), *VideoDirectory);
+	UE_LOG(LogTemp, Log, TEXT("[OpenCue] Render complete: success=%s, dir=%s (attempt %d)"),
+		bSuccess ? TEXT("true") : TEXT("false"), *VideoDirectory, RenderCompleteAck.Attempts + 1);
 
-	SendHTTPRequest(Url, TEXT("POST"), Message, Headers);
+	// Ahead of any queued progress, the server keys on the job id so a resend is harmless
+	FOpenCueHttpRequestOptions Options;
+	Options.bIdempotent = true;
+	Options.bSendFirst = true;
 
-	// Flush to ensure the request is sent
-	FHttpModule::Get().GetHttpManager().Flush(EHttpFlushReason::FullFlush);
+	RenderCompleteAck.OnSent(FPlatformTime::Seconds());
+	FOpenCueWorkerHttpClient::Send(TEXT("POST"), Url, Message, FHttpRequestCompleteDelegate::CreateWeakLambda(this,
+		[this](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			OnRenderCompleteResponse(INDEX_NONE, Response.IsValid() ? Response->GetResponseCode() : 0, Response.IsValid() ? Response->GetContentAsString() : FString());
+		}), Options);
 }
 
 bool UMoviePipelineOpenCuePIEExecutor::ParseTaskInfo(const FString& JsonString, FOpenCueTaskInfo& OutTaskInfo)
@@ -512,9 +753,8 @@ void UMoviePipelineOpenCuePIEExecutor::StartRenderTask()
 
 	if (!SetupRenderJob(CurrentTask))
 	{
-		CurrentTaskStatus = EOpenCueWorkerTaskStatus::Failed;
-		NotifyTaskDone(false);
-		CleanupRenderTask();
+		const bool bReportRenderComplete = false;
+		BeginCompletion(false, FString(), bReportRenderComplete);
 		return;
 	}
 
@@ -606,18 +846,116 @@ void UMoviePipelineOpenCuePIEExecutor::OnHeartbeatResponse(int32 RequestIndex, i
 
 void UMoviePipelineOpenCuePIEExecutor::OnTaskDoneResponse(int32 RequestIndex, int32 ResponseCode, const FString& Message)
 {
-	if (ResponseCode == 200)
+	if (CurrentTaskStatus != EOpenCueWorkerTaskStatus::Completing)
+	{
+		return;
+	}
+
+	if (ResponseCode >= 200 && ResponseCode < 300)
 	{
 		UE_LOG(LogTemp, Log, TEXT("[OpenCue] Task done acknowledged"));
+		TaskDoneAck.bAcknowledged = true;
 	}
 	else
 	{
 		UE_LOG(LogTemp, Warning, TEXT("[OpenCue] Task done notification failed: %d - %s"), ResponseCode, *Message);
+		TaskDoneAck.bNeedsResend = true;
+	}
+}
+
+void UMoviePipelineOpenCuePIEExecutor::OnRenderCompleteResponse(int32 RequestIndex, int32 ResponseCode, const FString& Message)
+{
+	if (CurrentTaskStatus != EOpenCueWorkerTaskStatus::Completing)
+	{
+		return;
 	}
 
-	// Return to idle state regardless
-	CurrentTaskStatus = EOpenCueWorkerTaskStatus::Idle;
+	if (ResponseCode >= 200 && ResponseCode < 300)
+	{
+		UE_LOG(LogTemp, Log, TEXT("[OpenCue] Render complete acknowledged"));
+		RenderCompleteAck.bAcknowledged = true;
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[OpenCue] Render complete notification failed: %d - %s"), ResponseCode, *Message);
+		RenderCompleteAck.bNeedsResend = true;
+	}
+}
+
+void UMoviePipelineOpenCuePIEExecutor::BeginCompletion(bool bSuccess, const FString& VideoDirectory, bool bReportRenderComplete)
+{
+	CurrentTaskStatus = EOpenCueWorkerTaskStatus::Completing;
+	bCompletionSuccess = bSuccess;
+	CompletionVideoDirectory = VideoDirectory;
+	CompletionStartTime = FPlatformTime::Seconds();
+
+	RenderCompleteAck = FOpenCueCompletionAck();
+	TaskDoneAck = FOpenCueCompletionAck();
+	RenderCompleteAck.bAcknowledged = !bReportRenderComplete;
+
+	FOpenCueWorkerStatusChannel::SendState(CurrentTask.JobId, bSuccess ? TEXT("completed") : TEXT("failed"));
+
+	if (bReportRenderComplete)
+	{
+		// Report completion to MRQ server
+		ReportRenderComplete(bSuccess, VideoDirectory);
+	}
+
+	// Notify worker pool
+	NotifyTaskDone(bSuccess);
+
+	CompletionTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &UMoviePipelineOpenCuePIEExecutor::TickCompletion),
+		CompletionTickIntervalSec);
+}
+
+bool UMoviePipelineOpenCuePIEExecutor::TickCompletion(float DeltaTime)
+{
+	if (CurrentTaskStatus != EOpenCueWorkerTaskStatus::Completing)
+	{
+		CompletionTickerHandle.Reset();
+		return false;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (RenderCompleteAck.bAcknowledged && TaskDoneAck.bAcknowledged)
+	{
+		UE_LOG(LogTemp, Log, TEXT("[OpenCue] Task %s completed in %.2fs"), *CurrentTask.TaskId, Now - CompletionStartTime);
+		FinishCompletion();
+		return false;
+	}
+
+	if (Now - CompletionStartTime >= CompletionAckTimeoutSec)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[OpenCue] Task %s not acknowledged after %.0fs (render-complete=%d, done=%d), returning to idle"),
+			*CurrentTask.TaskId, CompletionAckTimeoutSec, RenderCompleteAck.bAcknowledged, TaskDoneAck.bAcknowledged);
+		FinishCompletion();
+		return false;
+	}
+
+	if (RenderCompleteAck.ShouldResend(Now, CompletionRetryDelaySec, CompletionMaxAttempts))
+	{
+		ReportRenderComplete(bCompletionSuccess, CompletionVideoDirectory);
+	}
+	if (TaskDoneAck.ShouldResend(Now, CompletionRetryDelaySec, CompletionMaxAttempts))
+	{
+		NotifyTaskDone(bCompletionSuccess);
+	}
+
+	return true;
+}
+
+void UMoviePipelineOpenCuePIEExecutor::FinishCompletion()
+{
+	CompletionTickerHandle.Reset();
+
+	CurrentTaskStatus = bCompletionSuccess ?
+		EOpenCueWorkerTaskStatus::Completed :
+		EOpenCueWorkerTaskStatus::Failed;
+
+	// Cleanup and return to idle
 	CleanupRenderTask();
+	CurrentTaskStatus = EOpenCueWorkerTaskStatus::Idle;
 }
 
 void UMoviePipelineOpenCuePIEExecutor::OnMoviePipelineFinished(FMoviePipelineOutputData OutputData)
@@ -638,25 +976,26 @@ void UMoviePipelineOpenCuePIEExecutor::OnMoviePipelineFinished(FMoviePipelineOut
 		}
 	}
 
-	// Report completion to MRQ server
-	ReportRenderComplete(OutputData.bSuccess, VideoDirectory);
-
-	// Notify worker pool
-	NotifyTaskDone(OutputData.bSuccess);
-
-	CurrentTaskStatus = OutputData.bSuccess ?
-		EOpenCueWorkerTaskStatus::Completed :
-		EOpenCueWorkerTaskStatus::Failed;
-
-	// Cleanup and return to idle
-	CleanupRenderTask();
-	CurrentTaskStatus = EOpenCueWorkerTaskStatus::Idle;
+	// Keep ticking while the server acknowledges; the next lease is only polled once we are back to Idle
+	const bool bReportRenderComplete = true;
+	BeginCompletion(OutputData.bSuccess, VideoDirectory, bReportRenderComplete);
 }
 
 void UMoviePipelineOpenCuePIEExecutor::OnEnginePreExit()
 {
 	UE_LOG(LogTemp, Log, TEXT("[OpenCue] Engine pre-exit - stopping worker"));
+
+	// The process is going away, this is the one place where blocking on the completion requests is fine
+	if (CurrentTaskStatus == EOpenCueWorkerTaskStatus::Completing)
+	{
+		FOpenCueWorkerHttpClient::Flush(HttpFlushTimeoutSec);
+	}
 	StopWorker();
+	bKeepWorldWarm = false;
+	bWarmWorldIdle = false;
+
+	// Give background deletion of intermediate frames a bounded chance to finish before the process goes away
+	FMoviePipelineIntermediateFileCleanup::WaitForPendingDeletes(IntermediateCleanupTimeoutSec);
 }
 
 UWorld* UMoviePipelineOpenCuePIEExecutor::FindGameWorld() const
@@ -687,6 +1026,8 @@ FString UMoviePipelineOpenCuePIEExecutor::GetStatusString(EOpenCueWorkerTaskStat
 		return TEXT("assigned");
 	case EOpenCueWorkerTaskStatus::Running:
 		return TEXT("running");
+	case EOpenCueWorkerTaskStatus::Completing:
+		return TEXT("completing");
 	case EOpenCueWorkerTaskStatus::Completed:
 		return TEXT("completed");
 	case EOpenCueWorkerTaskStatus::Failed:
@@ -0,0 +1,677 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "OpenCueWorkerPoolSimulatorCommandlet.h"
+#include "OpenCueRetryBackoff.h"
+#include "OpenCueWorkerHttpClient.h"
+#include "MovieRenderPipelineCoreModule.h"
+#include "Containers/Ticker.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HttpManager.h"
+#include "HttpModule.h"
+#include "HttpPath.h"
+#include "HttpServerModule.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "IHttpRouter.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Math/RandomStream.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(OpenCueWorkerPoolSimulatorCommandlet)
+
+namespace
+{
+	struct FSimTask
+	{
+		FString TaskId;
+		FString JobId;
+		float EstimatedSeconds = 0.0f;
+	};
+
+	struct FSimStats
+	{
+		TMap<FString, int64> Requests;
+		TArray<double> LeaseLatencyMs;
+		int64 EmptyLeases = 0;
+		int64 Failures = 0;
+		int64 TasksDone = 0;
+		// Requests completing while the run is flushed afterwards are not part of the measurement
+		bool bCounting = true;
+
+		void Count(const TCHAR* InEndpoint)
+		{
+			if (bCounting)
+			{
+				++Requests.FindOrAdd(InEndpoint);
+			}
+		}
+	};
+
+	struct FSimConfig
+	{
+		FString PoolUrl;
+		float RenderSec = 2.0f;
+		float LeaseWaitSec = 25.0f;
+		int32 BatchSize = 1;
+		float HeartbeatSec = 5.0f;
+		float ProgressSec = 5.0f;
+		// Stand-in pool: new tasks per second as a fraction of what the workers can render, and the most tasks queued
+		float Load = 0.9f;
+		int32 MaxBacklog = 0;
+	};
+
+	FString ToJsonString(const TSharedRef<FJsonObject>& InObject)
+	{
+		FString Result;
+		TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Result);
+		FJsonSerializer::Serialize(InObject, Writer);
+		return Result;
+	}
+
+	template<typename LambdaType>
+	FHttpRequestHandler MakeHandler(LambdaType&& InLambda)
+	{
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+		return FHttpRequestHandler(Forward<LambdaType>(InLambda));
+#else
+		return FHttpRequestHandler::CreateLambda(Forward<LambdaType>(InLambda));
+#endif
+	}
+
+	/**
+	 * Stand-in worker pool. Tasks arrive at a steady rate into a bounded backlog; a lease is held until tasks are
+	 * available or its wait runs out, like a real pool's long-poll. Everything else is acknowledged right away.
+	 */
+	class FSimPool
+	{
+	public:
+		FSimPool(const FSimConfig& InConfig, int32 InNumWorkers)
+			: RenderSec(InConfig.RenderSec)
+			, ArrivalPerSec(InConfig.Load * InNumWorkers / FMath::Max(InConfig.RenderSec, 0.001f))
+			, MaxBacklog(InConfig.MaxBacklog > 0 ? InConfig.MaxBacklog : InNumWorkers * InConfig.BatchSize)
+			, Random(1234)
+		{
+			// Start with a full backlog so the first leases don't all wait for arrivals
+			Backlog = MaxBacklog;
+		}
+
+		bool Start(uint32 InPort)
+		{
+			Router = FHttpServerModule::Get().GetHttpRouter(InPort);
+			if (!Router.IsValid())
+			{
+				return false;
+			}
+
+			auto Respond = [](const FHttpResultCallback& OnComplete, EHttpServerResponseCodes Code, const FString& Body = FString())
+			{
+				TUniquePtr<FHttpServerResponse> Response = FHttpServerResponse::Create(Body, TEXT("application/json"));
+				Response->Code = Code;
+				OnComplete(MoveTemp(Response));
+			};
+
+			Routes.Add(Router->BindRoute(FHttpPath(TEXT("/workers/:id/lease")), EHttpServerRequestVerbs::VERB_GET,
+				MakeHandler([this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+				{
+					// Held until Tick has tasks for it or its wait ran out
+					const FString* MaxTasks = Request.QueryParams.Find(TEXT("max_tasks"));
+					const FString* Wait = Request.QueryParams.Find(TEXT("wait"));
+
+					FWaitingLease Lease;
+					Lease.MaxTasks = MaxTasks ? FMath::Max(FCString::Atoi(**MaxTasks), 1) : 1;
+					Lease.Deadline = FPlatformTime::Seconds() + (Wait ? FMath::Max(FCString::Atod(**Wait), 0.0) : 0.0);
+					Lease.OnComplete = OnComplete;
+					WaitingLeases.Add(MoveTemp(Lease));
+					return true;
+				})));
+
+			for (const TCHAR* Path : { TEXT("/workers/:id/ready"), TEXT("/workers/:id/heartbeat"), TEXT("/workers/:id/done"),
+				TEXT("/workers/:id/return"), TEXT("/ue-notifications/job/:id/progress") })
+			{
+				Routes.Add(Router->BindRoute(FHttpPath(Path), EHttpServerRequestVerbs::VERB_POST,
+					MakeHandler([Respond](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+					{
+						Respond(OnComplete, EHttpServerResponseCodes::Ok, TEXT("{}"));
+						return true;
+					})));
+			}
+
+			FHttpServerModule::Get().StartAllListeners();
+			return true;
+		}
+
+		void Stop()
+		{
+			// Release held long-polls so the workers' requests don't outlive the run
+			for (FWaitingLease& Lease : WaitingLeases)
+			{
+				TUniquePtr<FHttpServerResponse> Response = FHttpServerResponse::Create(FString(), TEXT("application/json"));
+				Response->Code = EHttpServerResponseCodes::NoContent;
+				Lease.OnComplete(MoveTemp(Response));
+			}
+			WaitingLeases.Reset();
+
+			if (Router.IsValid())
+			{
+				for (const FHttpRouteHandle& Route : Routes)
+				{
+					Router->UnbindRoute(Route);
+				}
+			}
+			Routes.Reset();
+		}
+
+		/** Add the tasks that arrived since the last tick, then serve held leases oldest first. */
+		void Tick(double InNow)
+		{
+			if (LastTickTime > 0.0)
+			{
+				ArrivalRemainder += ArrivalPerSec * (InNow - LastTickTime);
+				const int32 NumArrived = FMath::FloorToInt(ArrivalRemainder);
+				ArrivalRemainder -= NumArrived;
+				Backlog = FMath::Min(Backlog + NumArrived, MaxBacklog);
+			}
+			LastTickTime = InNow;
+
+			int32 NumServed = 0;
+			for (FWaitingLease& Lease : WaitingLeases)
+			{
+				if (Backlog == 0)
+				{
+					if (InNow < Lease.Deadline)
+					{
+						break;
+					}
+
+					TUniquePtr<FHttpServerResponse> Response = FHttpServerResponse::Create(FString(), TEXT("application/json"));
+					Response->Code = EHttpServerResponseCodes::NoContent;
+					Lease.OnComplete(MoveTemp(Response));
+					++NumServed;
+					continue;
+				}
+
+				const int32 NumTasks = FMath::Min(Lease.MaxTasks, Backlog);
+				Backlog -= NumTasks;
+
+				TArray<TSharedPtr<FJsonValue>> Tasks;
+				for (int32 TaskIndex = 0; TaskIndex < NumTasks; ++TaskIndex)
+				{
+					const int32 TaskNumber = NextTaskNumber++;
+					TSharedRef<FJsonObject> Task = MakeShared<FJsonObject>();
+					Task->SetStringField(TEXT("task_id"), FString::Printf(TEXT("task-%d"), TaskNumber));
+					Task->SetStringField(TEXT("job_id"), FString::Printf(TEXT("job-%d"), TaskNumber));
+					Task->SetStringField(TEXT("map_url"), TEXT("/Game/Sim/SimMap"));
+					Task->SetStringField(TEXT("level_sequence"), TEXT("/Game/Sim/SimSequence.SimSequence"));
+					Task->SetNumberField(TEXT("estimated_seconds"), RenderSec * Random.FRandRange(0.75f, 1.25f));
+					Tasks.Add(MakeShared<FJsonValueObject>(Task));
+				}
+
+				TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+				Root->SetArrayField(TEXT("tasks"), Tasks);
+				Lease.OnComplete(FHttpServerResponse::Create(ToJsonString(Root), TEXT("application/json")));
+				++NumServed;
+			}
+
+			// Leases are held in arrival order, so the ones behind the first still waiting have later deadlines too
+			WaitingLeases.RemoveAt(0, NumServed);
+		}
+
+	private:
+		struct FWaitingLease
+		{
+			int32 MaxTasks = 1;
+			double Deadline = 0.0;
+			FHttpResultCallback OnComplete;
+		};
+
+		float RenderSec;
+		double ArrivalPerSec;
+		int32 MaxBacklog;
+		int32 Backlog = 0;
+		double ArrivalRemainder = 0.0;
+		double LastTickTime = 0.0;
+		FRandomStream Random;
+		int32 NextTaskNumber = 0;
+		TSharedPtr<IHttpRouter> Router;
+		TArray<FHttpRouteHandle> Routes;
+		TArray<FWaitingLease> WaitingLeases;
+	};
+
+	/** One persistent worker: the request pattern of UOpenCueWorkerSubsystem with the render replaced by a timer. */
+	class FSimWorker : public TSharedFromThis<FSimWorker>
+	{
+	public:
+		FSimWorker(const FString& InWorkerId, const FSimConfig& InConfig, FSimStats& InStats)
+			: WorkerId(InWorkerId), Config(InConfig), Stats(InStats)
+		{
+		}
+
+		void Tick(double InNow)
+		{
+			if (!bReady)
+			{
+				if (!bRequestInFlight && Backoff.CanAttempt(InNow))
+				{
+					SendReady();
+				}
+				return;
+			}
+
+			if (InNow >= NextHeartbeatTime)
+			{
+				NextHeartbeatTime = InNow + Config.HeartbeatSec;
+				Post(TEXT("heartbeat"), FString::Printf(TEXT("%sworkers/%s/heartbeat"), *Config.PoolUrl, *WorkerId),
+					FString::Printf(TEXT("{\"busy\":%s}"), ActiveTask.IsSet() ? TEXT("true") : TEXT("false")));
+			}
+
+			if (ActiveTask.IsSet())
+			{
+				if (InNow >= RenderEndTime)
+				{
+					FinishTask();
+				}
+				else if (InNow >= NextProgressTime)
+				{
+					NextProgressTime = InNow + Config.ProgressSec;
+					const double Progress = 1.0 - (RenderEndTime - InNow) / FMath::Max(ActiveTask->EstimatedSeconds, 0.001f);
+					Post(TEXT("progress"), FString::Printf(TEXT("%sue-notifications/job/%s/progress"), *Config.PoolUrl, *ActiveTask->JobId),
+						FString::Printf(TEXT("{\"status\":\"rendering\",\"progress_percent\":%.3f}"), Progress));
+				}
+				return;
+			}
+
+			if (PendingTasks.Num() > 0)
+			{
+				StartTask(InNow);
+				return;
+			}
+
+			if (!LeaseRequest.IsValid() && Backoff.CanAttempt(InNow))
+			{
+				RequestLease();
+			}
+		}
+
+		void Stop()
+		{
+			if (LeaseRequest.IsValid())
+			{
+				LeaseRequest->OnProcessRequestComplete().Unbind();
+				LeaseRequest->CancelRequest();
+				LeaseRequest.Reset();
+			}
+		}
+
+	private:
+		void Post(const TCHAR* InEndpoint, const FString& InUrl, const FString& InBody, FHttpRequestCompleteDelegate InOnComplete = FHttpRequestCompleteDelegate())
+		{
+			// Each editor worker has its own connections, the worker id keeps ours apart in the shared client
+			FOpenCueHttpRequestOptions Options;
+			Options.bIdempotent = true;
+			Options.QueueKey = WorkerId;
+
+			// Counted once answered, so the rates are what the pool actually served
+			TWeakPtr<FSimWorker> WeakThis = AsShared();
+			FOpenCueWorkerHttpClient::Send(TEXT("POST"), InUrl, InBody, FHttpRequestCompleteDelegate::CreateLambda(
+				[WeakThis, InEndpoint, OnComplete = MoveTemp(InOnComplete)](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+				{
+					if (TSharedPtr<FSimWorker> This = WeakThis.Pin())
+					{
+						if (bWasSuccessful && Response.IsValid())
+						{
+							This->Stats.Count(InEndpoint);
+						}
+					}
+					OnComplete.ExecuteIfBound(Request, Response, bWasSuccessful);
+				}), Options);
+		}
+
+		void SendReady()
+		{
+			bRequestInFlight = true;
+			TWeakPtr<FSimWorker> WeakThis = AsShared();
+			Post(TEXT("ready"), FString::Printf(TEXT("%sworkers/%s/ready"), *Config.PoolUrl, *WorkerId), FString(),
+				FHttpRequestCompleteDelegate::CreateLambda([WeakThis](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+				{
+					if (TSharedPtr<FSimWorker> This = WeakThis.Pin())
+					{
+						This->bRequestInFlight = false;
+						if (bWasSuccessful && Response.IsValid() && Response->GetResponseCode() == 200)
+						{
+							This->Backoff.OnSuccess();
+							This->bReady = true;
+						}
+						else
+						{
+							++This->Stats.Failures;
+							This->Backoff.OnFailure(FPlatformTime::Seconds());
+						}
+					}
+				}));
+		}
+
+		void RequestLease()
+		{
+			FString Url = FString::Printf(TEXT("%sworkers/%s/lease?wait=%d"), *Config.PoolUrl, *WorkerId, FMath::CeilToInt(Config.LeaseWaitSec));
+			if (Config.BatchSize > 1)
+			{
+				Url += FString::Printf(TEXT("&max_tasks=%d"), Config.BatchSize);
+			}
+
+			FOpenCueHttpRequestOptions Options;
+			Options.TimeoutSec = Config.LeaseWaitSec + 10.0f;
+
+			const double SendTime = FPlatformTime::Seconds();
+			TWeakPtr<FSimWorker> WeakThis = AsShared();
+			LeaseRequest = FOpenCueWorkerHttpClient::SendExclusive(TEXT("GET"), Url, FString(),
+				FHttpRequestCompleteDelegate::CreateLambda([WeakThis, SendTime](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+				{
+					if (TSharedPtr<FSimWorker> This = WeakThis.Pin())
+					{
+						This->OnLeaseResponse(Response, bWasSuccessful, SendTime);
+					}
+				}), Options);
+		}
+
+		void OnLeaseResponse(FHttpResponsePtr Response, bool bWasSuccessful, double SendTime)
+		{
+			LeaseRequest.Reset();
+
+			const double Now = FPlatformTime::Seconds();
+			const int32 Code = bWasSuccessful && Response.IsValid() ? Response->GetResponseCode() : 0;
+			if (Code != 0)
+			{
+				Stats.Count(TEXT("lease"));
+			}
+			if (Code == 204)
+			{
+				Backoff.OnSuccess();
+				++Stats.EmptyLeases;
+				return;
+			}
+			if (Code != 200)
+			{
+				++Stats.Failures;
+				Backoff.OnFailure(Now);
+				return;
+			}
+
+			Backoff.OnSuccess();
+			Stats.LeaseLatencyMs.Add((Now - SendTime) * 1000.0);
+
+			TSharedPtr<FJsonObject> RootObj;
+			const TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(Response->GetContentAsString());
+			if (!FJsonSerializer::Deserialize(Reader, RootObj) || !RootObj.IsValid())
+			{
+				++Stats.Failures;
+				return;
+			}
+
+			TArray<TSharedPtr<FJsonObject>> TaskObjects;
+			const TArray<TSharedPtr<FJsonValue>>* TaskValues = nullptr;
+			if (RootObj->TryGetArrayField(TEXT("tasks"), TaskValues))
+			{
+				for (const TSharedPtr<FJsonValue>& TaskValue : *TaskValues)
+				{
+					TaskObjects.Add(TaskValue->AsObject());
+				}
+			}
+			else
+			{
+				TaskObjects.Add(RootObj);
+			}
+
+			for (const TSharedPtr<FJsonObject>& TaskObj : TaskObjects)
+			{
+				FSimTask& Task = PendingTasks.AddDefaulted_GetRef();
+				if (TaskObj.IsValid())
+				{
+					TaskObj->TryGetStringField(TEXT("task_id"), Task.TaskId);
+					TaskObj->TryGetStringField(TEXT("job_id"), Task.JobId);
+					double EstimatedSeconds = Config.RenderSec;
+					TaskObj->TryGetNumberField(TEXT("estimated_seconds"), EstimatedSeconds);
+					Task.EstimatedSeconds = static_cast<float>(EstimatedSeconds);
+				}
+			}
+		}
+
+		void StartTask(double InNow)
+		{
+			ActiveTask = PendingTasks[0];
+			PendingTasks.RemoveAt(0);
+			RenderEndTime = InNow + ActiveTask->EstimatedSeconds;
+			NextProgressTime = InNow + Config.ProgressSec;
+		}
+
+		void FinishTask()
+		{
+			TWeakPtr<FSimWorker> WeakThis = AsShared();
+			Post(TEXT("done"), FString::Printf(TEXT("%sworkers/%s/done"), *Config.PoolUrl, *WorkerId),
+				FString::Printf(TEXT("{\"task_id\":\"%s\",\"job_id\":\"%s\",\"success\":true}"), *ActiveTask->TaskId, *ActiveTask->JobId),
+				FHttpRequestCompleteDelegate::CreateLambda([WeakThis](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+				{
+					TSharedPtr<FSimWorker> This = WeakThis.Pin();
+					if (This && This->Stats.bCounting && bWasSuccessful && Response.IsValid() && Response->GetResponseCode() == 200)
+					{
+						++This->Stats.TasksDone;
+					}
+				}));
+			ActiveTask.Reset();
+		}
+
+		FString WorkerId;
+		const FSimConfig& Config;
+		FSimStats& Stats;
+		FOpenCueRetryBackoff Backoff;
+
+		bool bReady = false;
+		bool bRequestInFlight = false;
+		FHttpRequestPtr LeaseRequest;
+		TArray<FSimTask> PendingTasks;
+		TOptional<FSimTask> ActiveTask;
+		double RenderEndTime = 0.0;
+		double NextProgressTime = 0.0;
+		double NextHeartbeatTime = 0.0;
+	};
+
+	double Percentile(const TArray<double>& InSorted, double InPercentile)
+	{
+		if (InSorted.Num() == 0)
+		{
+			return 0.0;
+		}
+
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(InPercentile * InSorted.Num()) - 1, 0, InSorted.Num() - 1);
+		return InSorted[Index];
+	}
+
+	void PumpNetwork(double& InOutLastTime)
+	{
+		const double Now = FPlatformTime::Seconds();
+		const float DeltaTime = static_cast<float>(Now - InOutLastTime);
+		InOutLastTime = Now;
+
+		// The HTTP server listeners tick from the core ticker, client completions from the HTTP manager
+		FTSTicker::GetCoreTicker().Tick(DeltaTime);
+		FHttpModule::Get().GetHttpManager().Tick(DeltaTime);
+	}
+}
+
+UOpenCueWorkerPoolSimulatorCommandlet::UOpenCueWorkerPoolSimulatorCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UOpenCueWorkerPoolSimulatorCommandlet::Main(const FString& Params)
+{
+	FString WorkerCountList = TEXT("10,100,1000");
+	float DurationSec = 60.0f;
+	int32 Port = 9190;
+	FString ReportPath;
+	FSimConfig Config;
+
+	FParse::Value(*Params, TEXT("-Workers="), WorkerCountList);
+	FParse::Value(*Params, TEXT("-Duration="), DurationSec);
+	FParse::Value(*Params, TEXT("-RenderSec="), Config.RenderSec);
+	FParse::Value(*Params, TEXT("-LeaseWaitSec="), Config.LeaseWaitSec);
+	FParse::Value(*Params, TEXT("-BatchSize="), Config.BatchSize);
+	FParse::Value(*Params, TEXT("-HeartbeatSec="), Config.HeartbeatSec);
+	FParse::Value(*Params, TEXT("-ProgressSec="), Config.ProgressSec);
+	FParse::Value(*Params, TEXT("-Load="), Config.Load);
+	FParse::Value(*Params, TEXT("-MaxBacklog="), Config.MaxBacklog);
+	FParse::Value(*Params, TEXT("-Port="), Port);
+	FParse::Value(*Params, TEXT("-PoolUrl="), Config.PoolUrl);
+	FParse::Value(*Params, TEXT("-Report="), ReportPath);
+
+	const bool bLocalPool = Config.PoolUrl.IsEmpty();
+	if (bLocalPool)
+	{
+		Config.PoolUrl = FString::Printf(TEXT("http://127.0.0.1:%d/"), Port);
+	}
+	else if (!Config.PoolUrl.EndsWith(TEXT("/")))
+	{
+		Config.PoolUrl.Append(TEXT("/"));
+	}
+
+	TArray<int32> WorkerCounts;
+	{
+		TArray<FString> CountStrings;
+		WorkerCountList.ParseIntoArray(CountStrings, TEXT(","));
+		for (const FString& CountString : CountStrings)
+		{
+			const int32 Count = FCString::Atoi(*CountString.TrimStartAndEnd());
+			if (Count <= 0)
+			{
+				UE_LOG(LogMovieRenderPipeline, Error, TEXT("[PoolSimulator] Invalid worker count '%s'."), *CountString);
+				return 1;
+			}
+			WorkerCounts.Add(Count);
+		}
+	}
+
+	if (DurationSec <= 0.0f || Config.HeartbeatSec <= 0.0f || Config.ProgressSec <= 0.0f || Config.BatchSize <= 0 || Config.Load <= 0.0f)
+	{
+		UE_LOG(LogMovieRenderPipeline, Error, TEXT("[PoolSimulator] Duration, HeartbeatSec, ProgressSec, BatchSize and Load need to be positive."));
+		return 1;
+	}
+
+	TStringBuilder<1024> Report;
+	int32 NumIdleRuns = 0;
+	for (const int32 NumWorkers : WorkerCounts)
+	{
+		TUniquePtr<FSimPool> Pool;
+		if (bLocalPool)
+		{
+			Pool = MakeUnique<FSimPool>(Config, NumWorkers);
+			if (!Pool->Start(static_cast<uint32>(Port)))
+			{
+				UE_LOG(LogMovieRenderPipeline, Error, TEXT("[PoolSimulator] Could not listen on port %d."), Port);
+				return 1;
+			}
+		}
+
+		FSimStats Stats;
+		TArray<TSharedRef<FSimWorker>> Workers;
+		for (int32 Index = 0; Index < NumWorkers; ++Index)
+		{
+			Workers.Add(MakeShared<FSimWorker>(FString::Printf(TEXT("sim-%04d"), Index), Config, Stats));
+		}
+
+		UE_LOG(LogMovieRenderPipeline, Display, TEXT("[PoolSimulator] Running %d workers for %.0fs against %s."), NumWorkers, DurationSec, *Config.PoolUrl);
+
+		const double StartTime = FPlatformTime::Seconds();
+		double LastTime = StartTime;
+		while (FPlatformTime::Seconds() - StartTime < DurationSec && !IsEngineExitRequested())
+		{
+			PumpNetwork(LastTime);
+
+			const double Now = FPlatformTime::Seconds();
+			if (Pool.IsValid())
+			{
+				Pool->Tick(Now);
+			}
+
+			for (const TSharedRef<FSimWorker>& Worker : Workers)
+			{
+				Worker->Tick(Now);
+			}
+
+			FPlatformProcess::Sleep(0.001f);
+		}
+		const double WallSeconds = FPlatformTime::Seconds() - StartTime;
+		Stats.bCounting = false;
+
+		for (const TSharedRef<FSimWorker>& Worker : Workers)
+		{
+			Worker->Stop();
+		}
+		if (Pool.IsValid())
+		{
+			Pool->Stop();
+		}
+
+		// Queued heartbeats and done reports are not part of the measurement but must not leak into the next run
+		const double FlushStart = FPlatformTime::Seconds();
+		while (FOpenCueWorkerHttpClient::GetNumPending() > 0 && FPlatformTime::Seconds() - FlushStart < 10.0)
+		{
+			PumpNetwork(LastTime);
+			FPlatformProcess::Sleep(0.001f);
+		}
+		Workers.Reset();
+		Pool.Reset();
+
+		int64 TotalRequests = 0;
+		FString RequestRates;
+		Stats.Requests.KeySort(TLess<FString>());
+		for (const TPair<FString, int64>& Pair : Stats.Requests)
+		{
+			TotalRequests += Pair.Value;
+			RequestRates += FString::Printf(TEXT("%s%s %.1f"), RequestRates.IsEmpty() ? TEXT("") : TEXT(", "), *Pair.Key, Pair.Value / WallSeconds);
+		}
+
+		Stats.LeaseLatencyMs.Sort();
+		const double P50 = Percentile(Stats.LeaseLatencyMs, 0.50);
+		const double P95 = Percentile(Stats.LeaseLatencyMs, 0.95);
+		const double P99 = Percentile(Stats.LeaseLatencyMs, 0.99);
+		const double Throughput = Stats.TasksDone / WallSeconds;
+
+		UE_LOG(LogMovieRenderPipeline, Display, TEXT("[PoolSimulator] %d workers: %lld tasks done (%.2f tasks/s), %.1f requests/s (%s), lease latency p50 %.1f ms p95 %.1f ms p99 %.1f ms over %d leases, %lld empty, %lld failures"),
+			NumWorkers, Stats.TasksDone, Throughput, TotalRequests / WallSeconds, *RequestRates, P50, P95, P99, Stats.LeaseLatencyMs.Num(), Stats.EmptyLeases, Stats.Failures);
+
+		Report.Appendf(TEXT("%d,%.1f,%d,%.2f,%lld,%.3f,%.2f,%d,%.3f,%.3f,%.3f,%lld,%lld%s"),
+			NumWorkers, WallSeconds, Config.BatchSize, Config.RenderSec, Stats.TasksDone, Throughput, TotalRequests / WallSeconds,
+			Stats.LeaseLatencyMs.Num(), P50, P95, P99, Stats.EmptyLeases, Stats.Failures, LINE_TERMINATOR);
+
+		if (Stats.TasksDone == 0)
+		{
+			++NumIdleRuns;
+		}
+	}
+
+	if (bLocalPool)
+	{
+		FHttpServerModule::Get().StopAllListeners();
+	}
+
+	if (ReportPath.Len() > 0)
+	{
+		// Append so runs with different batch sizes or pools can be compared in one file.
+		FString ReportText;
+		if (!IFileManager::Get().FileExists(*ReportPath))
+		{
+			ReportText = FString(TEXT("workers,wall_seconds,batch_size,render_seconds,tasks_done,tasks_per_second,requests_per_second,leases,lease_p50_ms,lease_p95_ms,lease_p99_ms,empty_leases,failures")) + LINE_TERMINATOR;
+		}
+		ReportText += Report.ToString();
+		FFileHelper::SaveStringToFile(ReportText, *ReportPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
+	}
+
+	return NumIdleRuns > 0 ? 1 : 0;
+}
@@ -3,18 +3,48 @@
 
 #include "OpenCueWorkerSubsystem.h"
 #include "Editor.h"
+#include "EditorViewportClient.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
 #include "HttpModule.h"
+#include "OpenCueWorkerHttpClient.h"
+#include "OpenCueWorkerStatusChannel.h"
 #include "Interfaces/IHttpRequest.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Dom/JsonObject.h"
 #include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
 #include "Serialization/JsonWriter.h"
 
+#include "MoviePipeline.h"
+#include "MoviePipelineCustomEncoder.h"
+#include "MoviePipelineDetachedEncodes.h"
+#include "MoviePipelinePrimaryConfig.h"
 #include "MoviePipelineQueue.h"
 #include "MoviePipelineQueueSubsystem.h"
 #include "MoviePipelineOpenCuePIEExecutor.h"
 #include "MoviePipelineGameOverrideSetting.h"
 #include "AI/NavigationSystemBase.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "GenericPlatform/GenericPlatformHttp.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace
+{
+	FAutoConsoleCommand GDrainWorkerCommand(
+		TEXT("OpenCue.Worker.Drain"),
+		TEXT("Stop leasing, finish the current task, deregister from the worker pool and exit."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			if (UOpenCueWorkerSubsystem* Subsystem = GEditor ? GEditor->GetEditorSubsystem<UOpenCueWorkerSubsystem>() : nullptr)
+			{
+				Subsystem->RequestDrain(TEXT("console command"));
+			}
+		}));
+}
 
 void UOpenCueWorkerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
@@ -29,6 +59,39 @@ void UOpenCueWorkerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 	FParse::Value(FCommandLine::Get(), TEXT("-MRQWorkerId="), WorkerId);
 	FParse::Value(FCommandLine::Get(), TEXT("-WorkerPoolBaseUrl="), WorkerPoolBaseUrl);
 	FParse::Value(FCommandLine::Get(), TEXT("-MRQServerBaseUrl="), MRQServerBaseUrl);
+	FParse::Value(FCommandLine::Get(), TEXT("-LeaseWaitSec="), LeaseLongPollWaitSec);
+	LeaseLongPollWaitSec = FMath::Max(LeaseLongPollWaitSec, 0.0f);
+	bPrefetchLeases = !FParse::Param(FCommandLine::Get(), TEXT("NoLeasePrefetch"));
+	FParse::Value(FCommandLine::Get(), TEXT("-LeaseBatchSize="), LeaseBatchSize);
+	FParse::Value(FCommandLine::Get(), TEXT("-LeaseBatchMaxSec="), LeaseBatchMaxSec);
+	LeaseBatchSize = FMath::Max(LeaseBatchSize, 1);
+	FParse::Value(FCommandLine::Get(), TEXT("-IdleMaxFPS="), IdleMaxFPS);
+	FParse::Value(FCommandLine::Get(), TEXT("-RecycleAfterTasks="), RecycleAfterTasks);
+	FParse::Value(FCommandLine::Get(), TEXT("-RecycleGrowthMB="), RecycleGrowthMB);
+	FParse::Value(FCommandLine::Get(), TEXT("-RecycleExitCode="), RecycleExitCode);
+	bRecycleOnProjectedPeak = FParse::Param(FCommandLine::Get(), TEXT("RecycleOnProjectedPeak"));
+	FParse::Value(FCommandLine::Get(), TEXT("-IdleDrainSec="), IdleDrainSec);
+	FParse::Value(FCommandLine::Get(), TEXT("-DrainFile="), DrainFilePath);
+	FParse::Value(FCommandLine::Get(), TEXT("-DrainExitCode="), DrainExitCode);
+
+	OutputVolumePath = FPaths::ProjectSavedDir();
+	FParse::Value(FCommandLine::Get(), TEXT("-OutputVolumePath="), OutputVolumePath);
+	OutputVolumePath = FPaths::ConvertRelativePathToFull(OutputVolumePath);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("DetachedEncode")))
+	{
+		FParse::Value(FCommandLine::Get(), TEXT("-DetachedEncodeWaitSec="), DetachedEncodeWaitSec);
+		FMoviePipelineDetachedEncodes::SetEnabled(true);
+		DetachedEncodeHandle = FMoviePipelineDetachedEncodes::OnFinished().AddUObject(this, &UOpenCueWorkerSubsystem::OnDetachedEncodeFinished);
+	}
+
+	FString StatusChannelUrl;
+	if (FParse::Value(FCommandLine::Get(), TEXT("-StatusChannelUrl="), StatusChannelUrl))
+	{
+		// Heartbeats over the channel get no response, so the pool's drain request comes back as a record
+		StatusChannelHandle = FOpenCueWorkerStatusChannel::OnRecordReceived().AddUObject(this, &UOpenCueWorkerSubsystem::OnStatusChannelRecord);
+		FOpenCueWorkerStatusChannel::Connect(StatusChannelUrl, WorkerId);
+	}
 
 	if (!WorkerPoolBaseUrl.IsEmpty() && !WorkerPoolBaseUrl.EndsWith(TEXT("/")))
 	{
@@ -45,12 +108,48 @@ void UOpenCueWorkerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 		UE_LOG(LogTemp, Error, TEXT("%s: Missing args: -MRQWorkerId / -WorkerPoolBaseUrl / -MRQServerBaseUrl"), ANSI_TO_TCHAR(__FUNCTION__));
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("%s: Worker mode enabled. wid=%s, daemon=%s, server=%s"), ANSI_TO_TCHAR(__FUNCTION__), *WorkerId, *WorkerPoolBaseUrl, *MRQServerBaseUrl);
+	UE_LOG(LogTemp, Log, TEXT("%s: Worker mode enabled. wid=%s, daemon=%s, server=%s, lease wait=%.0fs"), ANSI_TO_TCHAR(__FUNCTION__), *WorkerId, *WorkerPoolBaseUrl, *MRQServerBaseUrl, LeaseLongPollWaitSec);
 	
 }
 
 void UOpenCueWorkerSubsystem::Deinitialize()
 {
+	if (LeaseRequest.IsValid())
+	{
+		// A long-poll can be held open by the pool for a while, don't let it complete into a dead subsystem
+		LeaseRequest->OnProcessRequestComplete().Unbind();
+		LeaseRequest->CancelRequest();
+		LeaseRequest.Reset();
+	}
+	bLeaseRequestInFlight = false;
+
+	if (PendingLeases.Num() > 0)
+	{
+		// Let the pool reassign tasks we leased but will never start
+		ReturnLeases(PendingLeases);
+		PendingLeases.Reset();
+		FOpenCueWorkerHttpClient::Flush(5.0);
+	}
+
+	if (DetachedEncodeHandle.IsValid())
+	{
+		// Their tasks are already done as far as the pool is concerned, the MRQ server still waits for the outputs
+		FMoviePipelineDetachedEncodes::WaitForAll(DetachedEncodeWaitSec);
+		FOpenCueWorkerHttpClient::Flush(5.0);
+		FMoviePipelineDetachedEncodes::OnFinished().Remove(DetachedEncodeHandle);
+		DetachedEncodeHandle.Reset();
+		FMoviePipelineDetachedEncodes::SetEnabled(false);
+	}
+
+	if (StatusChannelHandle.IsValid())
+	{
+		FOpenCueWorkerStatusChannel::OnRecordReceived().Remove(StatusChannelHandle);
+		StatusChannelHandle.Reset();
+	}
+	FOpenCueWorkerStatusChannel::Disconnect();
+
+	ExitIdleMode();
+
 	Super::Deinitialize();
 }
 
@@ -61,10 +160,28 @@ void UOpenCueWorkerSubsystem::Tick(float DeltaTime)
 		return;
 	}
 
+	TimeSinceDrainFileCheck += DeltaTime;
+	if (!DrainFilePath.IsEmpty() && !bDraining && TimeSinceDrainFileCheck >= 1.0f)
+	{
+		TimeSinceDrainFileCheck = 0.0f;
+		if (FPaths::FileExists(DrainFilePath))
+		{
+			BeginDrain(FString::Printf(TEXT("drain file %s exists"), *DrainFilePath), false);
+		}
+	}
+
+	TickAckedReports();
+
 	// First, ensure we've sent the ready signal before doing anything else
 	if (!bReady)
 	{
-		if (!bReadyRequestInFlight)
+		if (bDraining)
+		{
+			// Nothing leased yet, nothing to finish
+			TickDrain(false);
+			return;
+		}
+		if (!bReadyRequestInFlight && PoolBackoff.CanAttempt(FPlatformTime::Seconds()))
 		{
 			SendReadySignal();
 		}
@@ -79,34 +196,167 @@ void UOpenCueWorkerSubsystem::Tick(float DeltaTime)
 		SendHeartbeat();
 	}
 
-	if (bLeaseRequestInFlight)
+	const UMoviePipelineQueueSubsystem* QueueSubsystem = GEditor ? GEditor->GetEditorSubsystem<UMoviePipelineQueueSubsystem>() : nullptr;
+	// An executor holding a warm world between jobs is available for the next lease
+	const bool bRendering = QueueSubsystem && QueueSubsystem->IsRendering() && !GetWarmWorldExecutor(QueueSubsystem);
+
+	if (bDraining)
 	{
+		TickDrain(bRendering);
 		return;
 	}
 
-	if (GEditor)
+	if (ActiveLease.IsSet())
 	{
-		if (UMoviePipelineQueueSubsystem* QueueSubsystem = GEditor->GetEditorSubsystem<UMoviePipelineQueueSubsystem>())
+		TimeSinceMemorySample += DeltaTime;
+		if (TimeSinceMemorySample >= 1.0f)
 		{
-			if (QueueSubsystem->IsRendering())
-			{
-				bBusy = true;
-				return;
-			}
+			TimeSinceMemorySample = 0.0f;
+			TaskPeakMemoryMB = FMath::Max(TaskPeakMemoryMB, GetUsedPhysicalMB());
+		}
+	}
+	else if (bMeasureMemoryAfterTask && !bRendering && !GetWarmWorldExecutor(QueueSubsystem))
+	{
+		// Before the next queued task starts, so the measurement sees the previous world torn down. An idle warm world
+		// is still loaded and would count as growth, so this waits until it is released.
+		MeasureMemoryAfterTask();
+		if (bDraining)
+		{
+			return;
+		}
+	}
+
+	// Throttle the editor while waiting for work, full speed again as soon as a task starts
+	if (bRendering || PendingLeases.Num() > 0 || ActiveLease.IsSet())
+	{
+		TimeSinceActive = 0.0f;
+		ExitIdleMode();
+	}
+	else
+	{
+		TimeSinceActive += DeltaTime;
+		if (TimeSinceActive >= IdleModeDelaySec)
+		{
+			EnterIdleMode();
+		}
+
+		if (IdleDrainSec > 0.0f && TimeSinceActive >= IdleDrainSec)
+		{
+			BeginDrain(FString::Printf(TEXT("idle for %.0fs"), TimeSinceActive), false);
+			return;
 		}
 	}
 
-	bBusy = false;
+	if (!bRendering && PendingLeases.Num() > 0)
+	{
+		// Next batched or prefetched task, run back to back with the previous one
+		const FOpenCueLease Lease = PendingLeases[0];
+		PendingLeases.RemoveAt(0);
+		StartRenderFromLease(Lease);
+		return;
+	}
+
+	if (bRendering)
+	{
+		const UMoviePipelineOpenCuePIEExecutor* Executor = Cast<UMoviePipelineOpenCuePIEExecutor>(QueueSubsystem->GetActiveExecutor());
+		if (PrefetchedPackages.Num() > 0 && PrefetchedJobId == CurrentJobId && Executor && Executor->HasActivePipeline())
+		{
+			// The prefetched task is rendering, its packages are referenced by its world and pipeline now
+			PrefetchedPackages.Reset();
+			PrefetchedJobId.Reset();
+		}
+
+		// Queued task: start loading its packages once the running one is encoding
+		if (bPrefetchLeases && PendingLeases.Num() > 0 && PrefetchedJobId != PendingLeases[0].JobId && Executor && Executor->IsActivePipelineFinishing())
+		{
+			PrefetchLeasePackages(PendingLeases[0]);
+		}
+	}
+
+	if (bLeaseRequestInFlight)
+	{
+		return;
+	}
+
+	if (bRendering)
+	{
+		bBusy = true;
+		if (!CanPrefetchLease(QueueSubsystem))
+		{
+			return;
+		}
+	}
+	else
+	{
+		bBusy = false;
+	}
 
 	// Accumulate time for lease poll (since Editor Tick runs every frame)
 	TimeSinceLastLease += DeltaTime;
-	if (TimeSinceLastLease >= LeasePollIntervalSec)
+	if (TimeSinceLastLease >= LeasePollIntervalSec && PoolBackoff.CanAttempt(FPlatformTime::Seconds()))
 	{
 		TimeSinceLastLease = 0.0f;
 		RequestLease();
 	}
 }
 
+void UOpenCueWorkerSubsystem::EnterIdleMode()
+{
+	if (bIdleMode || IdleMaxFPS <= 0.0f || !GEditor)
+	{
+		return;
+	}
+
+	bIdleMode = true;
+
+	// Slate ticks and paints from the engine loop, so the cap throttles it along with the viewports
+	if (IConsoleVariable* MaxFPSVar = IConsoleManager::Get().FindConsoleVariable(TEXT("t.MaxFPS")))
+	{
+		SavedMaxFPS = MaxFPSVar->GetFloat();
+		MaxFPSVar->Set(IdleMaxFPS, ECVF_SetByCode);
+	}
+
+	// Non-realtime viewports only redraw when invalidated
+	for (FEditorViewportClient* ViewportClient : GEditor->GetAllViewportClients())
+	{
+		if (ViewportClient)
+		{
+			ViewportClient->AddRealtimeOverride(false, NSLOCTEXT("OpenCueWorker", "IdleMode", "OpenCue Worker Idle"));
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s: no active task, capping editor at %.0f fps"), ANSI_TO_TCHAR(__FUNCTION__), IdleMaxFPS);
+}
+
+void UOpenCueWorkerSubsystem::ExitIdleMode()
+{
+	if (!bIdleMode)
+	{
+		return;
+	}
+
+	bIdleMode = false;
+
+	if (IConsoleVariable* MaxFPSVar = IConsoleManager::Get().FindConsoleVariable(TEXT("t.MaxFPS")))
+	{
+		MaxFPSVar->Set(SavedMaxFPS, ECVF_SetByCode);
+	}
+
+	if (GEditor)
+	{
+		for (FEditorViewportClient* ViewportClient : GEditor->GetAllViewportClients())
+		{
+			if (ViewportClient)
+			{
+				// Viewports opened while idle never got the override
+				ViewportClient->RemoveRealtimeOverride(NSLOCTEXT("OpenCueWorker", "IdleMode", "OpenCue Worker Idle"), false);
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s: task active, editor back to full speed"), ANSI_TO_TCHAR(__FUNCTION__));
+}
+
 bool UOpenCueWorkerSubsystem::IsTickable() const
 {
 	return FTickableEditorObject::IsTickable();
@@ -133,34 +383,106 @@ void UOpenCueWorkerSubsystem::RequestLease()
 		return;
 	}
 
-	const FString InURL = FString::Printf(TEXT("%sworkers/%s/lease"), *WorkerPoolBaseUrl, *WorkerId);
-	FHttpRequestRef Request = FHttpModule::Get().CreateRequest();
-	Request->SetURL(InURL);
-	Request->SetVerb("GET");
-	Request->SetHeader(TEXT("Accept"), TEXT("application/json"));
-	Request->OnProcessRequestComplete().BindUObject(this, &UOpenCueWorkerSubsystem::OnLeaseResponse);
+	FOpenCueHttpRequestOptions Options;
+	TArray<FString> QueryParams;
+	if (LeaseLongPollWaitSec > 0.0f)
+	{
+		// Ask the pool to hold the request until a task is assigned, instead of answering 204 right away
+		QueryParams.Add(FString::Printf(TEXT("wait=%d"), FMath::CeilToInt(LeaseLongPollWaitSec)));
+		Options.TimeoutSec = LeaseLongPollWaitSec + LeaseLongPollTimeoutPaddingSec;
+	}
+	if (LeaseBatchSize > 1)
+	{
+		QueryParams.Add(FString::Printf(TEXT("max_tasks=%d"), LeaseBatchSize));
+		QueryParams.Add(FString::Printf(TEXT("max_batch_seconds=%d"), FMath::CeilToInt(LeaseBatchMaxSec)));
+	}
+	AppendLeaseAffinityParams(QueryParams);
+
+	FString InURL = FString::Printf(TEXT("%sworkers/%s/lease"), *WorkerPoolBaseUrl, *WorkerId);
+	if (QueryParams.Num() > 0)
+	{
+		InURL += TEXT("?") + FString::Join(QueryParams, TEXT("&"));
+	}
 
 	bLeaseRequestInFlight = true;
-	Request->ProcessRequest();
+	LeaseRequestStartTime = FPlatformTime::Seconds();
+	// The long-poll gets a connection of its own so heartbeats are not queued behind it
+	LeaseRequest = FOpenCueWorkerHttpClient::SendExclusive(TEXT("GET"), InURL, FString(),
+		FHttpRequestCompleteDelegate::CreateUObject(this, &UOpenCueWorkerSubsystem::OnLeaseResponse), Options);
+}
+
+void UOpenCueWorkerSubsystem::AppendLeaseAffinityParams(TArray<FString>& QueryParams) const
+{
+	// Map the editor world has loaded; PIE for the same map skips the editor map load
+	if (GEditor)
+	{
+		if (const UWorld* EditorWorld = GEditor->GetEditorWorldContext().World())
+		{
+			QueryParams.Add(TEXT("loaded_map=") + FGenericPlatformHttp::UrlEncode(EditorWorld->GetOutermost()->GetName()));
+		}
+	}
+
+	if (!WarmWorldMapUrl.IsEmpty() && GetWarmWorldExecutor(GEditor ? GEditor->GetEditorSubsystem<UMoviePipelineQueueSubsystem>() : nullptr))
+	{
+		QueryParams.Add(TEXT("warm_map_url=") + FGenericPlatformHttp::UrlEncode(WarmWorldMapUrl));
+	}
+
+	if (RecentSequences.Num() > 0)
+	{
+		QueryParams.Add(TEXT("recent_sequences=") + FGenericPlatformHttp::UrlEncode(FString::Join(RecentSequences, TEXT(","))));
+	}
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	QueryParams.Add(FString::Printf(TEXT("available_memory_mb=%llu"), static_cast<uint64>(MemoryStats.AvailablePhysical / (1024 * 1024))));
+
+	if (!AffinityKey.IsEmpty())
+	{
+		QueryParams.Add(TEXT("affinity_key=") + FGenericPlatformHttp::UrlEncode(AffinityKey));
+	}
 }
 
 void UOpenCueWorkerSubsystem::OnLeaseResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
 {
 	bLeaseRequestInFlight = false;
+	LeaseRequest.Reset();
+
+	// Re-issue right away only if the request was actually held open by the pool. Failures and a pool that
+	// ignores the wait parameter (204 straight back) keep the regular poll interval so we never spin.
+	const double HeldSec = FPlatformTime::Seconds() - LeaseRequestStartTime;
+	const bool bHeldOpen = LeaseLongPollWaitSec > 0.0f && HeldSec >= LeasePollIntervalSec;
+	TimeSinceLastLease = 0.0f;
+
 	if (!bWasSuccessful || !Response.IsValid())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("%s: lease request failed."), ANSI_TO_TCHAR(__FUNCTION__));
+		if (bHeldOpen && HeldSec >= LeaseLongPollWaitSec)
+		{
+			// Client side timeout of an idle long-poll, e.g. a proxy dropped it; not worth a warning
+			TimeSinceLastLease = LeasePollIntervalSec;
+			return;
+		}
+		PoolBackoff.OnFailure(FPlatformTime::Seconds());
+		UE_LOG(LogTemp, Warning, TEXT("%s: lease request failed, retrying in %.1fs"), ANSI_TO_TCHAR(__FUNCTION__), PoolBackoff.GetRemainingDelay(FPlatformTime::Seconds()));
 		return;
 	}
 
 	const int32 Code = Response->GetResponseCode();
+	if (Code == 200 || Code == 204)
+	{
+		PoolBackoff.OnSuccess();
+	}
 	if (Code == 204)
 	{
+		if (bHeldOpen)
+		{
+			TimeSinceLastLease = LeasePollIntervalSec;
+		}
 		return;
 	}
 	if (Code != 200)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("%s: lease response %d: %s"), ANSI_TO_TCHAR(__FUNCTION__), Code, *Response->GetContentAsString());
+		PoolBackoff.OnFailure(FPlatformTime::Seconds());
+		UE_LOG(LogTemp, Warning, TEXT("%s: lease response %d: %s, retrying in %.1fs"), ANSI_TO_TCHAR(__FUNCTION__), Code, *Response->GetContentAsString(),
+			PoolBackoff.GetRemainingDelay(FPlatformTime::Seconds()));
 		return;
 	}
 
@@ -173,25 +495,174 @@ void UOpenCueWorkerSubsystem::OnLeaseResponse(FHttpRequestPtr Request, FHttpResp
 		return;
 	}
 
-	FString JobId;
-	FString MapUrl;
-	FString LevelSequencePath;
-	RootObj->TryGetStringField(TEXT("job_id"), JobId);
-	RootObj->TryGetStringField(TEXT("map_url"), MapUrl);
-	RootObj->TryGetStringField(TEXT("level_sequence"), LevelSequencePath);
+	// The pool shrinks the fleet by answering a lease with {"drain": true} instead of a task
+	bool bPoolDrain = false;
+	if (RootObj->TryGetBoolField(TEXT("drain"), bPoolDrain) && bPoolDrain)
+	{
+		BeginDrain(TEXT("requested by the pool"), false);
+		return;
+	}
+
+	// Opaque routing hint from the pool, sent back with every following lease request
+	FString NewAffinityKey;
+	if (RootObj->TryGetStringField(TEXT("affinity_key"), NewAffinityKey))
+	{
+		AffinityKey = NewAffinityKey;
+	}
+
+	// Batch lease {"tasks": [...]}, or a single task as the root object
+	TArray<TSharedPtr<FJsonObject>> TaskObjects;
+	const TArray<TSharedPtr<FJsonValue>>* TaskValues = nullptr;
+	if (RootObj->TryGetArrayField(TEXT("tasks"), TaskValues))
+	{
+		for (const TSharedPtr<FJsonValue>& TaskValue : *TaskValues)
+		{
+			TaskObjects.Add(TaskValue->AsObject());
+		}
+	}
+	else
+	{
+		TaskObjects.Add(RootObj);
+	}
+
+	TArray<FOpenCueLease> Leases;
+	TArray<FOpenCueLease> OverCap;
+	float BatchSeconds = 0.0f;
+	for (const TSharedPtr<FJsonObject>& TaskObj : TaskObjects)
+	{
+		FOpenCueLease Lease;
+		if (!ParseLease(TaskObj, Lease))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s: lease missing fields: %s"), ANSI_TO_TCHAR(__FUNCTION__), *Body);
+			continue;
+		}
+
+		// Enforce our own caps in case the pool sent more than asked for; the first task is always taken
+		const bool bWithinCaps = Leases.Num() == 0 || (Leases.Num() < LeaseBatchSize && BatchSeconds + Lease.EstimatedSeconds <= LeaseBatchMaxSec);
+		if (!bWithinCaps)
+		{
+			OverCap.Add(MoveTemp(Lease));
+			continue;
+		}
+
+		BatchSeconds += Lease.EstimatedSeconds;
+		Leases.Add(MoveTemp(Lease));
+	}
+
+	if (OverCap.Num() > 0)
+	{
+		ReturnLeases(OverCap);
+	}
+
+	if (Leases.Num() == 0)
+	{
+		return;
+	}
+
+	if (Leases.Num() > 1)
+	{
+		UE_LOG(LogTemp, Log, TEXT("%s: leased batch of %d tasks (~%.0fs)"), ANSI_TO_TCHAR(__FUNCTION__), Leases.Num(), BatchSeconds);
+	}
 
-	if (JobId.IsEmpty() || MapUrl.IsEmpty() || LevelSequencePath.IsEmpty())
+	const UMoviePipelineQueueSubsystem* QueueSubsystem = GEditor ? GEditor->GetEditorSubsystem<UMoviePipelineQueueSubsystem>() : nullptr;
+	if (QueueSubsystem && QueueSubsystem->IsRendering() && !GetWarmWorldExecutor(QueueSubsystem))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("%s: lease missing fields: %s"), ANSI_TO_TCHAR(__FUNCTION__), *Body);
+		// Leased ahead while the previous task encodes; Tick starts them once that task completes
+		UE_LOG(LogTemp, Log, TEXT("%s: prefetched job=%s, waiting for the active render to complete"), ANSI_TO_TCHAR(__FUNCTION__), *Leases[0].JobId);
+		PendingLeases.Append(Leases);
+		PrefetchLeasePackages(PendingLeases[0]);
 		return;
 	}
 
-	StartRenderFromLease(JobId, MapUrl, LevelSequencePath);
+	const FOpenCueLease FirstLease = Leases[0];
+	Leases.RemoveAt(0);
+	PendingLeases.Append(Leases);
+	StartRenderFromLease(FirstLease);
+}
+
+bool UOpenCueWorkerSubsystem::ParseLease(const TSharedPtr<FJsonObject>& TaskObj, FOpenCueLease& OutLease)
+{
+	if (!TaskObj.IsValid())
+	{
+		return false;
+	}
+
+	TaskObj->TryGetStringField(TEXT("job_id"), OutLease.JobId);
+	TaskObj->TryGetStringField(TEXT("map_url"), OutLease.MapUrl);
+	TaskObj->TryGetStringField(TEXT("level_sequence"), OutLease.LevelSequencePath);
+	TaskObj->TryGetStringField(TEXT("task_id"), OutLease.TaskId);
+
+	double EstimatedSeconds = 0.0;
+	if (TaskObj->TryGetNumberField(TEXT("estimated_seconds"), EstimatedSeconds))
+	{
+		OutLease.EstimatedSeconds = FMath::Max(static_cast<float>(EstimatedSeconds), 0.0f);
+	}
+
+	return !OutLease.JobId.IsEmpty() && !OutLease.MapUrl.IsEmpty() && !OutLease.LevelSequencePath.IsEmpty();
+}
+
+bool UOpenCueWorkerSubsystem::CanPrefetchLease(const UMoviePipelineQueueSubsystem* QueueSubsystem) const
+{
+	if (!bPrefetchLeases || PendingLeases.Num() > 0 || !QueueSubsystem)
+	{
+		return false;
+	}
+
+	const UMoviePipelineOpenCuePIEExecutor* Executor = Cast<UMoviePipelineOpenCuePIEExecutor>(QueueSubsystem->GetActiveExecutor());
+	return Executor && Executor->IsActivePipelineFinishing();
+}
+
+void UOpenCueWorkerSubsystem::PrefetchLeasePackages(const FOpenCueLease& Lease)
+{
+	PrefetchedPackages.Reset();
+	PrefetchedJobId = Lease.JobId;
+
+	TArray<FString, TInlineAllocator<2>> PackageNames;
+	PackageNames.Add(FPackageName::ObjectPathToPackageName(StripMapOptions(Lease.MapUrl)));
+	PackageNames.Add(FPackageName::ObjectPathToPackageName(Lease.LevelSequencePath));
+
+	for (const FString& PackageName : PackageNames)
+	{
+		if (PackageName.IsEmpty())
+		{
+			continue;
+		}
+
+		// Already in memory (e.g. the map that is loaded right now) -> nothing to prefetch
+		if (UPackage* LoadedPackage = FindPackage(nullptr, *PackageName))
+		{
+			PrefetchedPackages.Add(LoadedPackage);
+			continue;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		LoadPackageAsync(PackageName, FLoadPackageAsyncDelegate::CreateWeakLambda(this,
+			[this, StartTime, JobId = Lease.JobId](const FName& LoadedPackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+			{
+				if (Result != EAsyncLoadingResult::Succeeded || !LoadedPackage)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("%s: failed to prefetch %s for job=%s"), ANSI_TO_TCHAR(__FUNCTION__), *LoadedPackageName.ToString(), *JobId);
+					return;
+				}
+
+				// Drop late completions for a lease that has already been started or replaced
+				if (PrefetchedJobId == JobId)
+				{
+					PrefetchedPackages.AddUnique(LoadedPackage);
+				}
+				UE_LOG(LogTemp, Log, TEXT("%s: prefetched %s for job=%s in %.2fs"), ANSI_TO_TCHAR(__FUNCTION__), *LoadedPackageName.ToString(), *JobId, FPlatformTime::Seconds() - StartTime);
+			}));
+	}
 }
 
-void UOpenCueWorkerSubsystem::StartRenderFromLease(const FString& JobId, const FString& MapUrl,
-	const FString& LevelSequencePath)
+void UOpenCueWorkerSubsystem::StartRenderFromLease(const FOpenCueLease& Lease)
 {
+	ExitIdleMode();
+
+	const FString& JobId = Lease.JobId;
+	const FString& MapUrl = Lease.MapUrl;
+	const FString& LevelSequencePath = Lease.LevelSequencePath;
+
 	if (!GEditor)
 	{
 		UE_LOG(LogTemp, Error, TEXT("%s: GEditor not ready; cannot start job: %s"), ANSI_TO_TCHAR(__FUNCTION__), *JobId);
@@ -205,6 +676,45 @@ void UOpenCueWorkerSubsystem::StartRenderFromLease(const FString& JobId, const F
 		return;
 	}
 
+	RecentSequences.Remove(LevelSequencePath);
+	RecentSequences.Insert(LevelSequencePath, 0);
+	if (RecentSequences.Num() > MaxRecentSequences)
+	{
+		RecentSequences.SetNum(MaxRecentSequences);
+	}
+
+	if (UMoviePipelineOpenCuePIEExecutor* WarmExecutor = GetWarmWorldExecutor(QueueSubsystem))
+	{
+		if (MapUrl == WarmWorldMapUrl)
+		{
+			if (!WarmWorldQueue)
+			{
+				WarmWorldQueue = NewObject<UMoviePipelineQueue>(this, TEXT("OpenCueWarmWorldQueue"));
+			}
+			WarmWorldQueue->DeleteAllJobs();
+
+			UMoviePipelineExecutorJob* WarmJob = AllocateLeaseJob(WarmWorldQueue, JobId, MapUrl, LevelSequencePath);
+			if (WarmExecutor->RenderInWarmWorld(WarmJob))
+			{
+				FOpenCueWorkerStatusChannel::SendState(JobId, TEXT("assigned"));
+				CurrentJobId = JobId;
+				ActiveLease = Lease;
+				TaskStartMemoryMB = TaskPeakMemoryMB = GetUsedPhysicalMB();
+				bBusy = true;
+				WatchExecutor(WarmExecutor);
+				UE_LOG(LogTemp, Log, TEXT("%s: start job=%s in warm world map=%s seq=%s"), ANSI_TO_TCHAR(__FUNCTION__), *JobId, *WarmJob->Map.ToString(), *WarmJob->Sequence.ToString());
+				return;
+			}
+		}
+
+		// Different map (or the warm world could not take the job): end the PIE session and start once it is down
+		UE_LOG(LogTemp, Log, TEXT("%s: job=%s needs map %s, releasing warm world of %s"), ANSI_TO_TCHAR(__FUNCTION__), *JobId, *MapUrl, *WarmWorldMapUrl);
+		WarmExecutor->ReleaseWarmWorld();
+		PendingLeases.Insert(Lease, 0);
+		bBusy = true;
+		return;
+	}
+
 	UMoviePipelineQueue* Queue = QueueSubsystem->GetQueue();
 	if (!Queue)
 	{
@@ -214,6 +724,426 @@ void UOpenCueWorkerSubsystem::StartRenderFromLease(const FString& JobId, const F
 
 	Queue->DeleteAllJobs();
 
+	UMoviePipelineExecutorJob* NewJob = AllocateLeaseJob(Queue, JobId, MapUrl, LevelSequencePath);
+
+	FOpenCueWorkerStatusChannel::SendState(JobId, TEXT("assigned"));
+
+	// Store current JobId for access by other systems (e.g., Executor)
+	CurrentJobId = JobId;
+	ActiveLease = Lease;
+	TaskStartMemoryMB = TaskPeakMemoryMB = GetUsedPhysicalMB();
+	WarmWorldMapUrl = MapUrl;
+
+	bBusy = true;
+
+	UE_LOG(LogTemp, Log, TEXT("%s: start job=%s map=%s seq=%s"), ANSI_TO_TCHAR(__FUNCTION__), *JobId, *NewJob->Map.ToString(), *NewJob->Sequence.ToString());
+
+	QueueSubsystem->RenderQueueWithExecutor(UMoviePipelineOpenCuePIEExecutor::StaticClass());
+	WatchExecutor(QueueSubsystem->GetActiveExecutor());
+}
+
+void UOpenCueWorkerSubsystem::WatchExecutor(UMoviePipelineExecutorBase* Executor)
+{
+	if (!Executor || WatchedExecutor.Get() == Executor)
+	{
+		return;
+	}
+
+	WatchedExecutor = Executor;
+
+	// Per job, so tasks rendered one after another in a warm world are reported individually
+	Executor->OnIndividualJobWorkFinished().AddWeakLambda(this, [this](FMoviePipelineOutputData OutputData)
+	{
+		if (OutputData.Job)
+		{
+			OnLeaseJobFinished(OutputData.Job->UserData, OutputData.bSuccess, GetVideoDirectory(OutputData));
+		}
+	});
+	Executor->OnExecutorFinished().AddUObject(this, &UOpenCueWorkerSubsystem::OnLeaseExecutorFinished);
+}
+
+FString UOpenCueWorkerSubsystem::GetVideoDirectory(const FMoviePipelineOutputData& OutputData)
+{
+	// Where the encoder wrote the video, else where the pipeline wrote its images
+	const UMoviePipeline* Pipeline = Cast<UMoviePipeline>(OutputData.Pipeline);
+	const UMoviePipelineCustomEncoder* Encoder = Pipeline ? Pipeline->GetPipelinePrimaryConfig()->FindSetting<UMoviePipelineCustomEncoder>() : nullptr;
+	if (Encoder && Encoder->GetOutputPaths().Num() > 0)
+	{
+		return FPaths::GetPath(Encoder->GetOutputPaths()[0]);
+	}
+
+	for (const FMoviePipelineShotOutputData& ShotData : OutputData.ShotData)
+	{
+		for (const TPair<FMoviePipelinePassIdentifier, FMoviePipelineRenderPassOutputData>& RenderPass : ShotData.RenderPassData)
+		{
+			if (RenderPass.Value.FilePaths.Num() > 0)
+			{
+				return FPaths::GetPath(RenderPass.Value.FilePaths[0]);
+			}
+		}
+	}
+
+	return FString();
+}
+
+void UOpenCueWorkerSubsystem::OnLeaseJobFinished(const FString& JobId, bool bSuccess, const FString& VideoDirectory)
+{
+	if (!ActiveLease.IsSet() || ActiveLease->JobId != JobId)
+	{
+		return;
+	}
+
+	const FOpenCueLease FinishedLease = ActiveLease.GetValue();
+	ActiveLease.Reset();
+
+	UE_LOG(LogTemp, Log, TEXT("%s: job=%s finished success=%d, %d leased task(s) queued"), ANSI_TO_TCHAR(__FUNCTION__), *JobId, bSuccess, PendingLeases.Num());
+	SendTaskDone(FinishedLease, bSuccess);
+
+	// With -DetachedEncode the video isn't written yet, OnDetachedEncodeFinished reports it
+	if (!FMoviePipelineDetachedEncodes::IsEncoding(JobId))
+	{
+		FOpenCueWorkerStatusChannel::SendState(JobId, bSuccess ? TEXT("completed") : TEXT("failed"));
+		SendRenderComplete(JobId, bSuccess, VideoDirectory, false);
+	}
+
+	++CompletedTaskCount;
+	TaskPeakMemoryMB = FMath::Max(TaskPeakMemoryMB, GetUsedPhysicalMB());
+	LargestTaskRiseMB = FMath::Max(LargestTaskRiseMB, TaskPeakMemoryMB - FMath::Min(TaskStartMemoryMB, TaskPeakMemoryMB));
+	bMeasureMemoryAfterTask = true;
+
+	// Doesn't need a measurement, which a warm world kept for the next job on the same map would hold off
+	if (RecycleAfterTasks > 0 && CompletedTaskCount >= RecycleAfterTasks)
+	{
+		BeginDrain(FString::Printf(TEXT("%d tasks completed"), CompletedTaskCount), true);
+	}
+}
+
+uint64 UOpenCueWorkerSubsystem::GetUsedPhysicalMB()
+{
+	return FPlatformMemory::GetStats().UsedPhysical / (1024 * 1024);
+}
+
+TSharedRef<FJsonObject> UOpenCueWorkerSubsystem::BuildCapabilities()
+{
+	constexpr uint64 BytesPerMB = 1024 * 1024;
+
+	// Hardware and versions don't change while the process runs, query them once
+	if (!StaticCapabilities.IsValid())
+	{
+		StaticCapabilities = MakeShared<FJsonObject>();
+		StaticCapabilities->SetNumberField(TEXT("logical_cores"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+		StaticCapabilities->SetNumberField(TEXT("physical_cores"), FPlatformMisc::NumberOfCores());
+		StaticCapabilities->SetNumberField(TEXT("physical_memory_mb"), static_cast<double>(FPlatformMemory::GetConstants().TotalPhysical / BytesPerMB));
+		StaticCapabilities->SetStringField(TEXT("cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+		StaticCapabilities->SetStringField(TEXT("gpu"), FPlatformMisc::GetPrimaryGPUBrand().TrimStartAndEnd());
+		StaticCapabilities->SetStringField(TEXT("engine_version"), FEngineVersion::Current().ToString());
+		if (TSharedPtr<IPlugin> OpenCuePlugin = IPluginManager::Get().FindPlugin(TEXT("OpenCueForUnreal")))
+		{
+			StaticCapabilities->SetStringField(TEXT("plugin_version"), OpenCuePlugin->GetDescriptor().VersionName);
+		}
+		StaticCapabilities->SetNumberField(TEXT("lease_batch_size"), LeaseBatchSize);
+		StaticCapabilities->SetBoolField(TEXT("detached_encode"), FMoviePipelineDetachedEncodes::IsEnabled());
+		StaticCapabilities->SetStringField(TEXT("output_volume"), OutputVolumePath);
+	}
+
+	// Copy, the status channel keeps the object it was sent as the base for the next delta
+	TSharedRef<FJsonObject> Capabilities = MakeShared<FJsonObject>(*StaticCapabilities);
+	Capabilities->SetNumberField(TEXT("free_memory_mb"), static_cast<double>(FPlatformMemory::GetStats().AvailablePhysical / BytesPerMB));
+
+	uint64 TotalDiskBytes = 0;
+	uint64 FreeDiskBytes = 0;
+	if (FPlatformMisc::GetDiskTotalAndFreeSpace(OutputVolumePath, TotalDiskBytes, FreeDiskBytes))
+	{
+		Capabilities->SetNumberField(TEXT("output_free_disk_mb"), static_cast<double>(FreeDiskBytes / BytesPerMB));
+	}
+
+	const UWorld* World = GEditor ? (GEditor->PlayWorld ? GEditor->PlayWorld.Get() : GEditor->GetEditorWorldContext().World()) : nullptr;
+	Capabilities->SetStringField(TEXT("loaded_map"), World ? UWorld::RemovePIEPrefix(World->GetOutermost()->GetName()) : FString());
+
+	return Capabilities;
+}
+
+void UOpenCueWorkerSubsystem::MeasureMemoryAfterTask()
+{
+	bMeasureMemoryAfterTask = false;
+
+	// Full purge so what is left is what the next task inherits, not garbage that is merely unreachable
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+	const FPlatformMemoryStats Stats = FPlatformMemory::GetStats();
+	const uint64 UsedMB = Stats.UsedPhysical / (1024 * 1024);
+	const uint64 AvailableMB = Stats.AvailablePhysical / (1024 * 1024);
+	const int64 GrowthMB = static_cast<int64>(UsedMB) - static_cast<int64>(BaselineMemoryMB);
+
+	UE_LOG(LogTemp, Log, TEXT("%s: after task %d rss=%llu MB (baseline %llu MB, growth %lld MB), largest task rise %llu MB, available %llu MB"),
+		ANSI_TO_TCHAR(__FUNCTION__), CompletedTaskCount, UsedMB, BaselineMemoryMB, GrowthMB, LargestTaskRiseMB, AvailableMB);
+
+	if (RecycleGrowthMB > 0 && BaselineMemoryMB > 0 && GrowthMB >= RecycleGrowthMB)
+	{
+		BeginDrain(FString::Printf(TEXT("memory grew %lld MB over baseline"), GrowthMB), true);
+	}
+	else if (bRecycleOnProjectedPeak && LargestTaskRiseMB > AvailableMB)
+	{
+		// Another task like the biggest one so far would not fit next to what we already hold
+		BeginDrain(FString::Printf(TEXT("projected peak %llu MB exceeds available memory"), UsedMB + LargestTaskRiseMB), true);
+	}
+}
+
+void UOpenCueWorkerSubsystem::RequestDrain(const FString& Reason)
+{
+	if (bWorkerMode)
+	{
+		BeginDrain(Reason, false);
+	}
+}
+
+void UOpenCueWorkerSubsystem::BeginDrain(const FString& Reason, bool bRestart)
+{
+	if (bDraining)
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("%s: %s worker: %s"), ANSI_TO_TCHAR(__FUNCTION__), bRestart ? TEXT("recycling") : TEXT("draining"), *Reason);
+	bDraining = true;
+	bRestartAfterDrain = bRestart;
+	DrainStartTime = FPlatformTime::Seconds();
+
+	if (LeaseRequest.IsValid())
+	{
+		LeaseRequest->OnProcessRequestComplete().Unbind();
+		LeaseRequest->CancelRequest();
+		LeaseRequest.Reset();
+	}
+	bLeaseRequestInFlight = false;
+
+	if (PendingLeases.Num() > 0)
+	{
+		ReturnLeases(PendingLeases);
+		PendingLeases.Reset();
+	}
+
+	// Tell the pool to stop leasing to us; the current task (if any) still finishes and reports done
+	const FString InURL = FString::Printf(TEXT("%sworkers/%s/drain"), *WorkerPoolBaseUrl, *WorkerId);
+
+	FString JsonBody;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonBody);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("reason"), Reason);
+	Writer->WriteValue(TEXT("restart"), bRestart);
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	FOpenCueHttpRequestOptions Options;
+	Options.bIdempotent = true;
+
+	bDrainRequestInFlight = true;
+	FOpenCueWorkerHttpClient::Send(TEXT("POST"), InURL, JsonBody,
+		FHttpRequestCompleteDelegate::CreateWeakLambda(this, [this](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			bDrainRequestInFlight = false;
+			if (!bWasSuccessful || !Response.IsValid() || Response->GetResponseCode() != 200)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("%s: drain request failed (%d), exiting anyway"), ANSI_TO_TCHAR(__FUNCTION__),
+					Response.IsValid() ? Response->GetResponseCode() : 0);
+			}
+		}), Options);
+}
+
+void UOpenCueWorkerSubsystem::TickDrain(bool bRendering)
+{
+	// Keep heartbeating (done by Tick) until the task in progress has finished and its reports are acknowledged
+	if (ActiveLease.IsSet() || bRendering || bDrainRequestInFlight || AckedReports.Num() > 0 || FMoviePipelineDetachedEncodes::GetNumActive() > 0)
+	{
+		return;
+	}
+
+	if (!bRestartAfterDrain)
+	{
+		// Scale-down: this worker id won't come back, let the pool forget it right away instead of timing it out
+		const FString InURL = FString::Printf(TEXT("%sworkers/%s/deregister"), *WorkerPoolBaseUrl, *WorkerId);
+
+		FOpenCueHttpRequestOptions Options;
+		Options.bIdempotent = true;
+
+		FOpenCueWorkerHttpClient::Send(TEXT("POST"), InURL, FString(),
+			FHttpRequestCompleteDelegate::CreateLambda([](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+			{
+				if (!bWasSuccessful || !Response.IsValid() || Response->GetResponseCode() != 200)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("%s: deregister failed (%d)"), ANSI_TO_TCHAR(__FUNCTION__),
+						Response.IsValid() ? Response->GetResponseCode() : 0);
+				}
+			}), Options);
+	}
+
+	FOpenCueWorkerHttpClient::Flush(5.0);
+
+	const int32 ExitCode = bRestartAfterDrain ? RecycleExitCode : DrainExitCode;
+	UE_LOG(LogTemp, Warning, TEXT("%s: exiting with code %d after %d task(s)%s, drained in %.0fs"), ANSI_TO_TCHAR(__FUNCTION__), ExitCode, CompletedTaskCount,
+		bRestartAfterDrain ? TEXT(" for a restart") : TEXT(""), FPlatformTime::Seconds() - DrainStartTime);
+	FPlatformMisc::RequestExitWithStatus(false, static_cast<uint8>(ExitCode));
+	bWorkerMode = false;
+}
+
+void UOpenCueWorkerSubsystem::OnLeaseExecutorFinished(UMoviePipelineExecutorBase* Executor, bool bSuccess)
+{
+	if (WatchedExecutor.Get() == Executor)
+	{
+		WatchedExecutor.Reset();
+	}
+
+	// Executor ended without reporting the job itself (e.g. it failed to start PIE)
+	if (ActiveLease.IsSet())
+	{
+		OnLeaseJobFinished(ActiveLease->JobId, bSuccess, FString());
+	}
+}
+
+void UOpenCueWorkerSubsystem::SendTaskDone(const FOpenCueLease& Lease, bool bSuccess)
+{
+	const FString InURL = FString::Printf(TEXT("%sworkers/%s/done"), *WorkerPoolBaseUrl, *WorkerId);
+
+	FString JsonBody;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonBody);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("task_id"), Lease.TaskId);
+	Writer->WriteValue(TEXT("job_id"), Lease.JobId);
+	Writer->WriteValue(TEXT("success"), bSuccess);
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	// The pool keys on task_id, so a resend after a reset connection is harmless
+	FOpenCueHttpRequestOptions Options;
+	Options.bIdempotent = true;
+
+	SendAcknowledged(FString::Printf(TEXT("done report for job=%s"), *Lease.JobId), InURL, JsonBody, Options);
+}
+
+void UOpenCueWorkerSubsystem::OnDetachedEncodeFinished(const FString& JobId, bool bSuccess, const TArray<FString>& OutputPaths)
+{
+	const FString VideoDirectory = OutputPaths.Num() > 0 ? FPaths::GetPath(OutputPaths[0]) : FString();
+	UE_LOG(LogTemp, Log, TEXT("%s: encode of job=%s finished, success=%d, dir=%s"), ANSI_TO_TCHAR(__FUNCTION__), *JobId, bSuccess, *VideoDirectory);
+
+	FOpenCueWorkerStatusChannel::SendState(JobId, bSuccess ? TEXT("encoded") : TEXT("encode_failed"));
+	SendRenderComplete(JobId, bSuccess, VideoDirectory, true);
+}
+
+void UOpenCueWorkerSubsystem::SendRenderComplete(const FString& JobId, bool bSuccess, const FString& VideoDirectory, bool bDetachedEncode)
+{
+	const FString InURL = FString::Printf(TEXT("%sue-notifications/job/%s/render-complete"), *MRQServerBaseUrl, *JobId);
+
+	FString JsonBody;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonBody);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("movie_pipeline_success"), bSuccess);
+	Writer->WriteValue(TEXT("video_directory"), VideoDirectory);
+	if (bDetachedEncode)
+	{
+		Writer->WriteValue(TEXT("detached_encode"), true);
+	}
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	// The server keys on the job id, a resend after a reset connection is harmless. Sent ahead of queued progress
+	FOpenCueHttpRequestOptions Options;
+	Options.bIdempotent = true;
+	Options.bSendFirst = true;
+
+	SendAcknowledged(FString::Printf(TEXT("render-complete for job=%s"), *JobId), InURL, JsonBody, Options);
+}
+
+void UOpenCueWorkerSubsystem::ReturnLeases(const TArray<FOpenCueLease>& Leases)
+{
+	const FString InURL = FString::Printf(TEXT("%sworkers/%s/return"), *WorkerPoolBaseUrl, *WorkerId);
+
+	// {"tasks": [{"task_id": "...", "job_id": "..."}, ...]}
+	FString JsonBody;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonBody);
+	Writer->WriteObjectStart();
+	Writer->WriteArrayStart(TEXT("tasks"));
+	for (const FOpenCueLease& Lease : Leases)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("task_id"), Lease.TaskId);
+		Writer->WriteValue(TEXT("job_id"), Lease.JobId);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	UE_LOG(LogTemp, Log, TEXT("%s: returning %d unstarted task(s) to the pool"), ANSI_TO_TCHAR(__FUNCTION__), Leases.Num());
+
+	// The pool ignores tasks that are no longer leased to us, so a resend is harmless
+	FOpenCueHttpRequestOptions Options;
+	Options.bIdempotent = true;
+	SendAcknowledged(FString::Printf(TEXT("return of %d task(s)"), Leases.Num()), InURL, JsonBody, Options);
+}
+
+void UOpenCueWorkerSubsystem::SendAcknowledged(const FString& Description, const FString& Url, const FString& Body, const FOpenCueHttpRequestOptions& Options)
+{
+	FOpenCueAckedReport& Report = AckedReports.AddDefaulted_GetRef();
+	Report.Id = NextAckedReportId++;
+	Report.Description = Description;
+	Report.Url = Url;
+	Report.Body = Body;
+	Report.Options = Options;
+	DispatchAckedReport(Report);
+}
+
+void UOpenCueWorkerSubsystem::DispatchAckedReport(FOpenCueAckedReport& Report)
+{
+	Report.Ack.OnSent(FPlatformTime::Seconds());
+	FOpenCueWorkerHttpClient::Send(TEXT("POST"), Report.Url, Report.Body,
+		FHttpRequestCompleteDelegate::CreateWeakLambda(this, [this, ReportId = Report.Id](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			OnAckedReportResponse(ReportId, bWasSuccessful && Response.IsValid() ? Response->GetResponseCode() : 0);
+		}), Report.Options);
+}
+
+void UOpenCueWorkerSubsystem::OnAckedReportResponse(int32 ReportId, int32 ResponseCode)
+{
+	const int32 Index = AckedReports.IndexOfByPredicate([ReportId](const FOpenCueAckedReport& Report) { return Report.Id == ReportId; });
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	FOpenCueAckedReport& Report = AckedReports[Index];
+	if (ResponseCode >= 200 && ResponseCode < 300)
+	{
+		AckedReports.RemoveAt(Index);
+		return;
+	}
+
+	if (Report.Ack.Attempts >= ReportMaxAttempts)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s: %s not acknowledged after %d attempt(s) (%d), giving up"), ANSI_TO_TCHAR(__FUNCTION__),
+			*Report.Description, Report.Ack.Attempts, ResponseCode);
+		AckedReports.RemoveAt(Index);
+		return;
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("%s: %s failed (%d), resending"), ANSI_TO_TCHAR(__FUNCTION__), *Report.Description, ResponseCode);
+	Report.Ack.bNeedsResend = true;
+}
+
+void UOpenCueWorkerSubsystem::TickAckedReports()
+{
+	const double Now = FPlatformTime::Seconds();
+	for (FOpenCueAckedReport& Report : AckedReports)
+	{
+		if (Report.Ack.ShouldResend(Now, ReportRetryDelaySec, ReportMaxAttempts))
+		{
+			DispatchAckedReport(Report);
+		}
+	}
+}
+
+UMoviePipelineExecutorJob* UOpenCueWorkerSubsystem::AllocateLeaseJob(UMoviePipelineQueue* Queue, const FString& JobId,
+	const FString& MapUrl, const FString& LevelSequencePath) const
+{
 	UMoviePipelineExecutorJob* NewJob = Queue->AllocateNewJob(UMoviePipelineExecutorJob::StaticClass());
 	NewJob->JobName = JobId;
 	NewJob->UserData = JobId;
@@ -241,14 +1171,13 @@ void UOpenCueWorkerSubsystem::StartRenderFromLease(const FString& JobId, const F
 		}
 	}
 
-	// Store current JobId for access by other systems (e.g., Executor)
-	CurrentJobId = JobId;
-
-	bBusy = true;
-
-	UE_LOG(LogTemp, Log, TEXT("%s: start job=%s map=%s seq=%s"), ANSI_TO_TCHAR(__FUNCTION__), *JobId, *NewJob->Map.ToString(), *NewJob->Sequence.ToString());
+	return NewJob;
+}
 
-	QueueSubsystem->RenderQueueWithExecutor(UMoviePipelineOpenCuePIEExecutor::StaticClass());
+UMoviePipelineOpenCuePIEExecutor* UOpenCueWorkerSubsystem::GetWarmWorldExecutor(const UMoviePipelineQueueSubsystem* QueueSubsystem)
+{
+	UMoviePipelineOpenCuePIEExecutor* Executor = QueueSubsystem ? Cast<UMoviePipelineOpenCuePIEExecutor>(QueueSubsystem->GetActiveExecutor()) : nullptr;
+	return Executor && Executor->IsWarmWorldIdle() ? Executor : nullptr;
 }
 
 FString UOpenCueWorkerSubsystem::StripMapOptions(const FString& MapUrl)
@@ -295,7 +1224,27 @@ void UOpenCueWorkerSubsystem::SendHeartbeat()
 {
 	UE_LOG(LogTemp, Log, TEXT("%s: Sending heartbeat busy=%d, inFlight=%d"), ANSI_TO_TCHAR(__FUNCTION__), bBusy, bHeartbeatRequestInFlight);
 
+	TSharedRef<FJsonObject> HeartbeatFields = MakeShared<FJsonObject>();
+	HeartbeatFields->SetBoolField(TEXT("busy"), bBusy);
+	HeartbeatFields->SetStringField(TEXT("job_id"), bBusy ? CurrentJobId : FString());
+	HeartbeatFields->SetNumberField(TEXT("pool_retries"), static_cast<double>(PoolBackoff.GetTotalFailures()));
+	HeartbeatFields->SetNumberField(TEXT("pool_circuit_trips"), PoolBackoff.GetTotalTrips());
+	HeartbeatFields->SetNumberField(TEXT("detached_encodes"), FMoviePipelineDetachedEncodes::GetNumActive());
+	HeartbeatFields->SetBoolField(TEXT("draining"), bDraining);
+	HeartbeatFields->SetObjectField(TEXT("capabilities"), BuildCapabilities());
+	if (FOpenCueWorkerStatusChannel::SendHeartbeat(HeartbeatFields))
+	{
+		return;
+	}
+
+	// An idle worker's heartbeat paces like a lease call and doubles as the half-open probe. A busy worker keeps
+	// sending them, or the pool would take it for dead and hand its task to someone else.
 	const double Now = FPlatformTime::Seconds();
+	if (!bBusy && !PoolBackoff.CanAttempt(Now))
+	{
+		return;
+	}
+
 	if (bHeartbeatRequestInFlight)
 	{
 		// Safety check: if heartbeat has been in flight far too long ( >15s ), assume it failed/stuck and reset
@@ -312,27 +1261,27 @@ void UOpenCueWorkerSubsystem::SendHeartbeat()
 
 	const FString InURL = FString::Printf(TEXT("%sworkers/%s/heartbeat"), *WorkerPoolBaseUrl, *WorkerId);
 
-	// Build JSON body: {"busy": true/false}
+	// Build JSON body: {"busy": true/false, "pool_retries": N, "pool_circuit_trips": N, "detached_encodes": N, "draining": true/false, "capabilities": {...}}
+	TSharedRef<FJsonObject> BodyObject = MakeShared<FJsonObject>();
+	BodyObject->SetBoolField(TEXT("busy"), bBusy);
+	BodyObject->SetNumberField(TEXT("pool_retries"), static_cast<double>(PoolBackoff.GetTotalFailures()));
+	BodyObject->SetNumberField(TEXT("pool_circuit_trips"), PoolBackoff.GetTotalTrips());
+	BodyObject->SetNumberField(TEXT("detached_encodes"), FMoviePipelineDetachedEncodes::GetNumActive());
+	BodyObject->SetBoolField(TEXT("draining"), bDraining);
+	BodyObject->SetObjectField(TEXT("capabilities"), BuildCapabilities());
+
 	FString JsonBody;
 	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonBody);
-	Writer->WriteObjectStart();
-	Writer->WriteValue(TEXT("busy"), bBusy);
-	Writer->WriteObjectEnd();
-	Writer->Close();
+	FJsonSerializer::Serialize(BodyObject, Writer);
 
-	FHttpRequestRef Request = FHttpModule::Get().CreateRequest();
-	Request->SetURL(InURL);
-	Request->SetVerb("POST");
-	Request->SetHeader("Content-Type", "application/json");
-	// Disable connection reuse to prevent libcurl 'rewind' failures when server resets connection
-	Request->SetHeader(TEXT("Connection"), TEXT("close"));
-	Request->SetContentAsString(JsonBody);
-	Request->SetTimeout(10.0f);
-	Request->OnProcessRequestComplete().BindUObject(this, &UOpenCueWorkerSubsystem::OnHeartbeatResponse);
+	// Sent over the kept-alive connection to the pool; a reset connection is retried by the client
+	FOpenCueHttpRequestOptions Options;
+	Options.bIdempotent = true;
 
 	bHeartbeatRequestInFlight = true;
 	LastHeartbeatTime = Now;
-	Request->ProcessRequest();
+	FOpenCueWorkerHttpClient::Send(TEXT("POST"), InURL, JsonBody,
+		FHttpRequestCompleteDelegate::CreateUObject(this, &UOpenCueWorkerSubsystem::OnHeartbeatResponse), Options);
 }
 
 void UOpenCueWorkerSubsystem::OnHeartbeatResponse(FHttpRequestPtr Request, FHttpResponsePtr Response,
@@ -342,6 +1291,7 @@ void UOpenCueWorkerSubsystem::OnHeartbeatResponse(FHttpRequestPtr Request, FHttp
 
 	if (!bWasSuccessful || !Response.IsValid())
 	{
+		PoolBackoff.OnFailure(FPlatformTime::Seconds());
 		UE_LOG(LogTemp, Warning, TEXT("%s: heartbeat request failed"), ANSI_TO_TCHAR(__FUNCTION__));
 		return;
 	}
@@ -349,7 +1299,29 @@ void UOpenCueWorkerSubsystem::OnHeartbeatResponse(FHttpRequestPtr Request, FHttp
 	const int32 Code = Response->GetResponseCode();
 	if (Code != 200)
 	{
+		PoolBackoff.OnFailure(FPlatformTime::Seconds());
 		UE_LOG(LogTemp, Warning, TEXT("%s: heartbeat response %d: %s"), ANSI_TO_TCHAR(__FUNCTION__), Code, *Response->GetContentAsString());
+		return;
+	}
+
+	PoolBackoff.OnSuccess();
+
+	// {"drain": true} asks a busy worker to leave once its current task is done
+	TSharedPtr<FJsonObject> RootObj;
+	const TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(Response->GetContentAsString());
+	bool bPoolDrain = false;
+	if (FJsonSerializer::Deserialize(Reader, RootObj) && RootObj.IsValid() && RootObj->TryGetBoolField(TEXT("drain"), bPoolDrain) && bPoolDrain)
+	{
+		BeginDrain(TEXT("requested by the pool"), false);
+	}
+}
+
+void UOpenCueWorkerSubsystem::OnStatusChannelRecord(const FString& Type, const TSharedRef<FJsonObject>& Record)
+{
+	// {"t":"drain"}, the channel's counterpart of {"drain": true} in a heartbeat response
+	if (Type == TEXT("drain") && bWorkerMode)
+	{
+		BeginDrain(TEXT("requested by the pool over the status channel"), false);
 	}
 }
 
@@ -364,16 +1336,20 @@ void UOpenCueWorkerSubsystem::SendReadySignal()
 
 	const FString InURL = FString::Printf(TEXT("%sworkers/%s/ready"), *WorkerPoolBaseUrl, *WorkerId);
 
-	FHttpRequestRef Request = FHttpModule::Get().CreateRequest();
-	Request->SetURL(InURL);
-	Request->SetVerb("POST");
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-	Request->SetHeader(TEXT("Connection"), TEXT("close"));
-	Request->SetTimeout(10.0f);
-	Request->OnProcessRequestComplete().BindUObject(this, &UOpenCueWorkerSubsystem::OnReadyResponse);
+	// Build JSON body: {"capabilities": {...}}, so the pool can size leases to this node
+	TSharedRef<FJsonObject> BodyObject = MakeShared<FJsonObject>();
+	BodyObject->SetObjectField(TEXT("capabilities"), BuildCapabilities());
+
+	FString JsonBody;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonBody);
+	FJsonSerializer::Serialize(BodyObject, Writer);
+
+	FOpenCueHttpRequestOptions Options;
+	Options.bIdempotent = true;
 
 	bReadyRequestInFlight = true;
-	Request->ProcessRequest();
+	FOpenCueWorkerHttpClient::Send(TEXT("POST"), InURL, JsonBody,
+		FHttpRequestCompleteDelegate::CreateUObject(this, &UOpenCueWorkerSubsystem::OnReadyResponse), Options);
 }
 
 void UOpenCueWorkerSubsystem::OnReadyResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
@@ -382,19 +1358,26 @@ void UOpenCueWorkerSubsystem::OnReadyResponse(FHttpRequestPtr Request, FHttpResp
 
 	if (!bWasSuccessful || !Response.IsValid())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("%s: Ready signal failed, will retry..."), ANSI_TO_TCHAR(__FUNCTION__));
+		PoolBackoff.OnFailure(FPlatformTime::Seconds());
+		UE_LOG(LogTemp, Warning, TEXT("%s: Ready signal failed, retrying in %.1fs"), ANSI_TO_TCHAR(__FUNCTION__), PoolBackoff.GetRemainingDelay(FPlatformTime::Seconds()));
 		return;
 	}
 
 	const int32 Code = Response->GetResponseCode();
 	if (Code == 200)
 	{
+		PoolBackoff.OnSuccess();
 		bReady = true;
+
+		// Memory growth is measured against the editor as it is before the first task
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+		BaselineMemoryMB = GetUsedPhysicalMB();
 		UE_LOG(LogTemp, Log, TEXT("%s: Worker is now READY. Starting lease polling and heartbeat."), ANSI_TO_TCHAR(__FUNCTION__));
 	}
 	else
 	{
-		UE_LOG(LogTemp, Warning, TEXT("%s: Ready signal response %d: %s, will retry..."),
-			ANSI_TO_TCHAR(__FUNCTION__), Code, *Response->GetContentAsString());
+		PoolBackoff.OnFailure(FPlatformTime::Seconds());
+		UE_LOG(LogTemp, Warning, TEXT("%s: Ready signal response %d: %s, retrying in %.1fs"),
+			ANSI_TO_TCHAR(__FUNCTION__), Code, *Response->GetContentAsString(), PoolBackoff.GetRemainingDelay(FPlatformTime::Seconds()));
 	}
 }
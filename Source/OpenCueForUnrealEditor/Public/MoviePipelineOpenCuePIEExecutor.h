@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "MoviePipelinePIEExecutor.h"
+#include "OpenCueRetryBackoff.h"
 #include "MoviePipelineOpenCuePIEExecutor.generated.h"
 
 class UMoviePipelineQueue;
@@ -12,6 +13,7 @@ class UMoviePipelineOutputSetting;
 class UMoviePipelineGameOverrideSetting;
 class UMoviePipelineCustomEncoder;
 class ULevelSequence;
+struct FMoviePipelineEncoderProgress;
 
 // Worker task status
 UENUM(BlueprintType)
@@ -20,6 +22,7 @@ enum class EOpenCueWorkerTaskStatus : uint8
 	Idle,           // Waiting for task lease
 	Assigned,       // Task assigned, preparing
 	Running,        // Rendering in progress
+	Completing,     // Render finished, waiting for the server to acknowledge completion
 	Completed,      // Task completed successfully
 	Failed          // Task failed
 };
@@ -86,6 +89,9 @@ protected:
 
 	void HandleIndividualJobFinished(FMoviePipelineOutputData OutputData);
 
+	/** Track a job queued by UOpenCueWorkerSubsystem so its progress is reported like the own worker loop's tasks */
+	void BeginLeasedJob(const UMoviePipelineExecutorJob* InJob);
+
 	UFUNCTION()
 	void OnReceiveJobInfo(int32 RequestIndex, int32 ResponseCode, const FString& Message);
 public:
@@ -110,6 +116,21 @@ public:
 	UFUNCTION(BlueprintPure, Category = "OpenCue")
 	const FOpenCueTaskInfo& GetCurrentTask() const { return CurrentTask; }
 
+	/** True once the active pipeline has rendered all frames and is finalizing or exporting (encoding) */
+	bool IsActivePipelineFinishing() const;
+
+	/** True while a movie pipeline exists for the current job, i.e. its world is loaded */
+	bool HasActivePipeline() const { return ActiveMoviePipeline != nullptr; }
+
+	/** True while the last job has finished and the PIE world is kept loaded for another job on the same map */
+	bool IsWarmWorldIdle() const { return bWarmWorldIdle; }
+
+	/** Render InJob in the warm PIE world with a new pipeline. Fails if no world is warm or InJob targets another map. */
+	bool RenderInWarmWorld(UMoviePipelineExecutorJob* InJob);
+
+	/** End the warm PIE session, which lets the executor finish */
+	void ReleaseWarmWorld();
+
 protected:
 	/** Poll for new task lease from Worker Pool */
 	void PollForLease();
@@ -120,8 +141,8 @@ protected:
 	/** Notify Worker Pool that task is done */
 	void NotifyTaskDone(bool bSuccess);
 
-	/** Report render progress to server */
-	void ReportProgress(float Progress, int32 EtaSeconds = -1);
+	/** Report render progress to server, optionally including encoder throughput */
+	void ReportProgress(float Progress, int32 EtaSeconds = -1, const FMoviePipelineEncoderProgress* EncoderProgress = nullptr);
 
 	/** Report render completion to server */
 	void ReportRenderComplete(bool bSuccess, const FString& VideoDirectory);
@@ -148,6 +169,14 @@ protected:
 	UFUNCTION()
 	void OnTaskDoneResponse(int32 RequestIndex, int32 ResponseCode, const FString& Message);
 
+	UFUNCTION()
+	void OnRenderCompleteResponse(int32 RequestIndex, int32 ResponseCode, const FString& Message);
+
+	/** Send the completion notifications and wait for their acknowledgement without blocking the game thread */
+	void BeginCompletion(bool bSuccess, const FString& VideoDirectory, bool bReportRenderComplete);
+	bool TickCompletion(float DeltaTime);
+	void FinishCompletion();
+
 	/** Ticker callbacks */
 	bool TickLeasePoll(float DeltaTime);
 	bool TickHeartbeat(float DeltaTime);
@@ -159,6 +188,13 @@ protected:
 	/** Find the game world */
 	UWorld* FindGameWorld() const;
 
+	/** Keep the PIE session alive when a pipeline finishes, and release it after an idle timeout */
+	void TickWarmWorld();
+	void OnWarmWorldPipelineFinished(FMoviePipelineOutputData OutputData);
+
+	/** Skips the PIE executor's own report of a job that was already reported when its world was kept warm */
+	virtual void OnIndividualJobFinishedImpl(FMoviePipelineOutputData InOutputData) override;
+
 	/** Get status string for API */
 	FString GetStatusString(EOpenCueWorkerTaskStatus Status) const;
 
@@ -180,6 +216,34 @@ protected:
 	UPROPERTY()
 	float HeartbeatIntervalSec = 10.0f;
 
+	// Max seconds to block on exit for completion/done notifications still in flight
+	UPROPERTY()
+	float HttpFlushTimeoutSec = 30.0f;
+
+	// Completion acknowledgement: resend unacknowledged notifications, give up and return to Idle after the timeout
+	UPROPERTY()
+	float CompletionAckTimeoutSec = 60.0f;
+
+	UPROPERTY()
+	float CompletionRetryDelaySec = 2.0f;
+
+	UPROPERTY()
+	int32 CompletionMaxAttempts = 5;
+
+	const float CompletionTickIntervalSec = 0.25f;
+
+	// Max seconds to wait on exit for intermediate frame deletion running in the background
+	UPROPERTY()
+	float IntermediateCleanupTimeoutSec = 60.0f;
+
+	// Keep the PIE world loaded between jobs on the same map, in -MRQWorkerMode only (-NoWarmWorld disables)
+	UPROPERTY()
+	bool bKeepWorldWarm = true;
+
+	// Seconds an idle warm world is kept before the PIE session ends (-WarmWorldIdleTimeout=)
+	UPROPERTY()
+	float WarmWorldIdleTimeoutSec = 60.0f;
+
 	// Current state
 	UPROPERTY()
 	EOpenCueWorkerTaskStatus CurrentTaskStatus = EOpenCueWorkerTaskStatus::Idle;
@@ -209,9 +273,28 @@ protected:
 	UPROPERTY()
 	UMoviePipelineGameOverrideSetting* GameOverrideSetting = nullptr;
 
+	// Warm world state
+	TWeakObjectPtr<UMoviePipeline> WarmWorldWatchedPipeline;
+	// Pipeline started by RenderInWarmWorld, whose job is reported through OnIndividualJobWorkFinished by us
+	TWeakObjectPtr<UMoviePipeline> WarmWorldPipeline;
+	// Job of the PIE executor's own pipeline, reported early when the world was kept warm
+	TWeakObjectPtr<UMoviePipelineExecutorJob> WarmWorldReportedJob;
+	bool bWarmWorldIdle = false;
+	bool bReleasingWarmWorld = false;
+	double WarmWorldIdleStartTime = 0.0;
+	int32 WarmWorldJobCount = 0;
+
+	// Completion state, one per notification that needs the server's acknowledgement
+	FOpenCueCompletionAck RenderCompleteAck;
+	FOpenCueCompletionAck TaskDoneAck;
+	bool bCompletionSuccess = false;
+	FString CompletionVideoDirectory;
+	double CompletionStartTime = 0.0;
+
 	// Ticker handles
 	FTSTicker::FDelegateHandle LeasePollTickerHandle;
 	FTSTicker::FDelegateHandle HeartbeatTickerHandle;
+	FTSTicker::FDelegateHandle CompletionTickerHandle;
 
 	// Progress tracking
 	double LastProgressReportTime = 0.0;
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "OpenCueWorkerPoolSimulatorCommandlet.generated.h"
+
+/**
+ * Load test for the worker lease protocol without booting editors. Runs N simulated workers in this process that speak
+ * the persistent worker protocol (ready, long-polled batch leases, heartbeats, progress, done) through the same
+ * FOpenCueWorkerHttpClient and FOpenCueRetryBackoff the editor workers use. Rendering is replaced by a timer of the
+ * task's estimated_seconds. Unless -PoolUrl= points at a real pool, a stand-in pool is served on -Port= from this
+ * process: tasks arrive at -Load times what the workers can render into a backlog of at most -MaxBacklog tasks
+ * (default one batch per worker), and leases are held until tasks are available or their wait runs out.
+ *
+ *   UnrealEditor-Cmd <Project> -run=OpenCueWorkerPoolSimulator -nullrhi -unattended
+ *       [-Workers=10,100,1000] [-Duration=60] [-RenderSec=2] [-LeaseWaitSec=25] [-BatchSize=1]
+ *       [-HeartbeatSec=5] [-ProgressSec=5] [-Load=0.9] [-MaxBacklog=<tasks>] [-Port=9190] [-PoolUrl=<url>]
+ *       [-Report=<csv>]
+ *
+ * Logs the rates of answered requests per endpoint, lease latency p50/p95/p99 and task throughput for every worker
+ * count. Every simulated worker has its own request queue and so its own connections, like separate editor processes;
+ * raise [HTTP] HttpMaxConnectionsPerServer for 1000 workers.
+ *
+ * Returns 0 if every run completed tasks.
+ */
+UCLASS()
+class OPENCUEFORUNREALEDITOR_API UOpenCueWorkerPoolSimulatorCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UOpenCueWorkerPoolSimulatorCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
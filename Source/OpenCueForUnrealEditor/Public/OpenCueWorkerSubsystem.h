@@ -5,8 +5,35 @@
 #include "CoreMinimal.h"
 #include "EditorSubsystem.h"
 #include "Interfaces/IHttpRequest.h"
+#include "OpenCueRetryBackoff.h"
+#include "OpenCueWorkerHttpClient.h"
 #include "OpenCueWorkerSubsystem.generated.h"
 
+class FJsonObject;
+
+// A task leased from the worker pool
+struct FOpenCueLease
+{
+	FString JobId;
+	FString MapUrl;
+	FString LevelSequencePath;
+	// Pool side id of the task, echoed in done/return reports (may be empty for older pools)
+	FString TaskId;
+	// Estimated render time from the pool, 0 if unknown
+	float EstimatedSeconds = 0.0f;
+};
+
+// A done, return or render-complete report that is resent until it is acknowledged
+struct FOpenCueAckedReport
+{
+	int32 Id = 0;
+	FString Description;
+	FString Url;
+	FString Body;
+	FOpenCueHttpRequestOptions Options;
+	FOpenCueCompletionAck Ack;
+};
+
 /**
  * 
  */
@@ -33,13 +60,64 @@ public:
 	FString GetCurrentJobId() const;
 
 	void SetCurrentJobId(const FString& JobId) { CurrentJobId = JobId; }
+
+	// Graceful scale-down: stop leasing, finish the current task, deregister and exit with -DrainExitCode
+	void RequestDrain(const FString& Reason);
 	
 private:
 	void RequestLease();
 
+	// Affinity hints so the pool can route tasks to workers that already have the map/sequence loaded
+	void AppendLeaseAffinityParams(TArray<FString>& QueryParams) const;
+
 	void OnLeaseResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
 
-	void StartRenderFromLease(const FString& JobId, const FString& MapUrl, const FString& LevelSequencePath);
+	static bool ParseLease(const TSharedPtr<FJsonObject>& TaskObj, FOpenCueLease& OutLease);
+
+	// Capability document for ready and heartbeats: cores, memory, versions, free memory/disk and the loaded map
+	TSharedRef<FJsonObject> BuildCapabilities();
+
+	// Memory based recycling: measure RSS after GC once a task ended and no warm world is held, and decide whether this
+	// process should be replaced
+	static uint64 GetUsedPhysicalMB();
+	void MeasureMemoryAfterTask();
+	// Stop leasing, return unstarted leases and tell the pool; TickDrain exits once the current task has reported.
+	// bRestart asks the supervisor for a fresh process (recycle), otherwise the worker deregisters (scale-down).
+	void BeginDrain(const FString& Reason, bool bRestart);
+	void TickDrain(bool bRendering);
+
+	// Idle low-power mode: cap the frame rate and stop realtime viewports while no task is active
+	void EnterIdleMode();
+	void ExitIdleMode();
+
+	void StartRenderFromLease(const FOpenCueLease& Lease);
+	class UMoviePipelineExecutorJob* AllocateLeaseJob(class UMoviePipelineQueue* Queue, const FString& JobId, const FString& MapUrl, const FString& LevelSequencePath) const;
+
+	// Per-task completion of batched leases
+	void WatchExecutor(class UMoviePipelineExecutorBase* Executor);
+	void OnLeaseJobFinished(const FString& JobId, bool bSuccess, const FString& VideoDirectory);
+	void OnLeaseExecutorFinished(class UMoviePipelineExecutorBase* Executor, bool bSuccess);
+	void SendTaskDone(const FOpenCueLease& Lease, bool bSuccess);
+	// Render-complete to the MRQ server, the only notification the server gets for a leased job besides progress
+	void SendRenderComplete(const FString& JobId, bool bSuccess, const FString& VideoDirectory, bool bDetachedEncode);
+	static FString GetVideoDirectory(const struct FMoviePipelineOutputData& OutputData);
+	// Render-complete for a job whose encode outlived its pipeline (-DetachedEncode)
+	void OnDetachedEncodeFinished(const FString& JobId, bool bSuccess, const TArray<FString>& OutputPaths);
+	// Hand leased but unstarted tasks back to the pool
+	void ReturnLeases(const TArray<FOpenCueLease>& Leases);
+
+	// Send a report and resend it from TickAckedReports until it gets a 2xx or runs out of attempts
+	void SendAcknowledged(const FString& Description, const FString& Url, const FString& Body, const FOpenCueHttpRequestOptions& Options);
+	void DispatchAckedReport(FOpenCueAckedReport& Report);
+	void OnAckedReportResponse(int32 ReportId, int32 ResponseCode);
+	void TickAckedReports();
+
+	// Active executor if it is idle with its PIE world kept loaded for a job on the same map
+	static class UMoviePipelineOpenCuePIEExecutor* GetWarmWorldExecutor(const class UMoviePipelineQueueSubsystem* QueueSubsystem);
+
+	// Lease prefetch: while the active pipeline finalizes/exports, lease the next task and async load its packages
+	bool CanPrefetchLease(const class UMoviePipelineQueueSubsystem* QueueSubsystem) const;
+	void PrefetchLeasePackages(const FOpenCueLease& Lease);
 
 	// URL parsing helpers
 	static FString StripMapOptions(const FString& MapUrl);
@@ -48,6 +126,8 @@ private:
 	// Heartbeat
 	void SendHeartbeat();
 	void OnHeartbeatResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
+	// Records the pool pushes over -StatusChannelUrl=
+	void OnStatusChannelRecord(const FString& Type, const TSharedRef<FJsonObject>& Record);
 
 	// Ready signal - notify worker pool that this worker is ready to accept tasks
 	void SendReadySignal();
@@ -66,7 +146,101 @@ private:
 	FString WorkerPoolBaseUrl;
 	FString MRQServerBaseUrl;
 
+	// Lease long-poll: the pool holds GET workers/{id}/lease?wait=N open until a task is available or N seconds pass.
+	// 0 disables the wait parameter and falls back to plain interval polling.
+	float LeaseLongPollWaitSec = 25.0f;
+	// Added to the long-poll wait for the HTTP timeout so the server side wait always expires first
+	float LeaseLongPollTimeoutPaddingSec = 10.0f;
+	double LeaseRequestStartTime = 0.0;
+	FHttpRequestPtr LeaseRequest;
+
 	float LeasePollIntervalSec = 1.0f;
+
+	// Paces ready/lease retries after pool failures and stops them for a while once the pool looks down
+	FOpenCueRetryBackoff PoolBackoff;
+
+	// Leased tasks not started yet (batch leases, or leased while the previous task was still encoding), run in order
+	TArray<FOpenCueLease> PendingLeases;
+	// Lease being rendered, reported done when its job finishes
+	TOptional<FOpenCueLease> ActiveLease;
+	TWeakObjectPtr<class UMoviePipelineExecutorBase> WatchedExecutor;
+	// Packages of the next pending lease loaded ahead of time, held until its render is under way
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UPackage>> PrefetchedPackages;
+	FString PrefetchedJobId;
+	bool bPrefetchLeases = true;
+
+	// Batch leases: ask for up to this many tasks per lease (1 = single task) ...
+	int32 LeaseBatchSize = 4;
+	// ... whose estimated durations add up to at most this many seconds
+	float LeaseBatchMaxSec = 600.0f;
+
+	// Volume whose free space is advertised (-OutputVolumePath=, default the project's Saved directory)
+	FString OutputVolumePath;
+	TSharedPtr<FJsonObject> StaticCapabilities;
+
+	// Recycle policies, each 0 = off: after this many tasks, after this much RSS growth over the post-ready baseline,
+	// or with -RecycleOnProjectedPeak when RSS after GC plus the largest rise seen during a task would not fit in
+	// physical memory
+	int32 RecycleAfterTasks = 0;
+	int32 RecycleGrowthMB = 0;
+	bool bRecycleOnProjectedPeak = false;
+	// Exit code asking the supervisor to start a fresh worker (EX_TEMPFAIL)
+	int32 RecycleExitCode = 75;
+
+	// Drain triggers: idle this long without a task (-IdleDrainSec=, 0 = off), or this file appearing (-DrainFile=),
+	// besides the pool's drain flag and OpenCue.Worker.Drain
+	float IdleDrainSec = 0.0f;
+	FString DrainFilePath;
+	float TimeSinceDrainFileCheck = 0.0f;
+	// Exit code after a drain, telling an autoscaler the worker left on purpose and must not be restarted
+	int32 DrainExitCode = 78;
+
+	int32 CompletedTaskCount = 0;
+	uint64 BaselineMemoryMB = 0;
+	uint64 TaskStartMemoryMB = 0;
+	uint64 TaskPeakMemoryMB = 0;
+	uint64 LargestTaskRiseMB = 0;
+	float TimeSinceMemorySample = 0.0f;
+	bool bMeasureMemoryAfterTask = false;
+	bool bDraining = false;
+	bool bRestartAfterDrain = false;
+	bool bDrainRequestInFlight = false;
+	double DrainStartTime = 0.0;
+
+	// -DetachedEncode: pipelines end once their encodes are launched, each job reports render-complete when its encode
+	// exits while the next task renders. Shutdown waits this long for encodes still running.
+	FDelegateHandle DetachedEncodeHandle;
+	float DetachedEncodeWaitSec = 600.0f;
+
+	// Records pushed by the pool over the status channel
+	FDelegateHandle StatusChannelHandle;
+
+	// Frame rate cap while idle (-IdleMaxFPS=, 0 disables idle mode), applied after IdleModeDelaySec without a task
+	float IdleMaxFPS = 5.0f;
+	float IdleModeDelaySec = 2.0f;
+	float TimeSinceActive = 0.0f;
+	bool bIdleMode = false;
+	// t.MaxFPS before idle mode lowered it
+	float SavedMaxFPS = 0.0f;
+
+	// Map url the current PIE world was started with; leases for the same url reuse the world while it is kept warm
+	FString WarmWorldMapUrl;
+	// Holds the job rendered in a warm world, separate from the queue the executor is still executing
+	UPROPERTY(Transient)
+	TObjectPtr<class UMoviePipelineQueue> WarmWorldQueue;
+
+	// Most recently rendered level sequences, newest first, reported as lease affinity hint
+	TArray<FString> RecentSequences;
+	static constexpr int32 MaxRecentSequences = 8;
+	// Last affinity_key handed out by the pool
+	FString AffinityKey;
+	// Reports waiting for their acknowledgement, same pacing as the PIE executor's completion notifications
+	TArray<FOpenCueAckedReport> AckedReports;
+	int32 NextAckedReportId = 0;
+	float ReportRetryDelaySec = 2.0f;
+	int32 ReportMaxAttempts = 5;
+
 	float HeartbeatPollIntervalSec = 5.0f;
 	float TimeSinceLastHeartbeat = 0.0f;
 	float TimeSinceLastLease = 0.0f;
@@ -11,6 +11,7 @@ public class OpenCueForUnrealUtils : ModuleRules
             new string[]
             {
                 "Core",
+                "HTTP",
                 "MovieRenderPipelineCore",
                 "MovieRenderPipelineSettings",
             }
@@ -21,7 +22,10 @@ public class OpenCueForUnrealUtils : ModuleRules
             {
                 "CoreUObject",
                 "Engine",
+                "ImageWrapper",
+                "Json",
                 "MovieRenderPipelineRenderPasses",
+                "WebSockets",
             }
         );
     }
@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "MoviePipelineChunkStitcher.h"
+#include "MoviePipelineCommandLineEncoderSettings.h"
+#include "MovieRenderPipelineCoreModule.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	bool ParseChunkDirectoryName(const FString& InName, int32& OutStartFrame, int32& OutEndFrame)
+	{
+		FString Start;
+		FString End;
+		if (!InName.Split(TEXT("-"), &Start, &End) || !Start.IsNumeric() || !End.IsNumeric())
+		{
+			return false;
+		}
+
+		OutStartFrame = FCString::Atoi(*Start);
+		OutEndFrame = FCString::Atoi(*End);
+		return OutEndFrame >= OutStartFrame;
+	}
+
+	FString WriteConcatList(const FString& InPath, const TArray<FString>& InFiles)
+	{
+		TStringBuilder<1024> StringBuilder;
+		for (const FString& File : InFiles)
+		{
+			StringBuilder.Appendf(TEXT("file 'file:%s'%s"), *File, LINE_TERMINATOR);
+		}
+		FFileHelper::SaveStringToFile(StringBuilder.ToString(), *InPath);
+		return InPath;
+	}
+}
+
+const TCHAR* FMoviePipelineChunkStitcher::FragmentListFileName = TEXT("fragments.txt");
+
+TArray<FMoviePipelineChunkStitcher::FChunk> FMoviePipelineChunkStitcher::FindChunks(const FString& InJobDirectory)
+{
+	TArray<FString> DirectoryNames;
+	IFileManager::Get().FindFiles(DirectoryNames, *(InJobDirectory / TEXT("*")), false, true);
+
+	TArray<FChunk> Chunks;
+	for (const FString& DirectoryName : DirectoryNames)
+	{
+		FChunk Chunk;
+		if (ParseChunkDirectoryName(DirectoryName, Chunk.StartFrame, Chunk.EndFrame))
+		{
+			Chunk.Directory = InJobDirectory / DirectoryName;
+			Chunks.Add(MoveTemp(Chunk));
+		}
+	}
+
+	Chunks.Sort([](const FChunk& A, const FChunk& B) { return A.StartFrame < B.StartFrame; });
+	return Chunks;
+}
+
+bool FMoviePipelineChunkStitcher::Stitch(const FString& InJobDirectory, const FString& InOutputDirectory, const bool bInAllowGaps, TArray<FString>& OutOutputPaths)
+{
+	const UMoviePipelineCommandLineEncoderSettings* EncoderSettings = GetDefault<UMoviePipelineCommandLineEncoderSettings>();
+
+	const TArray<FChunk> Chunks = FindChunks(InJobDirectory);
+	if (Chunks.Num() == 0)
+	{
+		UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("No <start>-<end> chunk directories found in '%s'."), *InJobDirectory);
+		return false;
+	}
+
+	// Ranges have an inclusive end, so each chunk starts right after the previous one. Anything else is a missing
+	// chunk or an overlap that would duplicate frames.
+	for (int32 Index = 1; Index < Chunks.Num(); ++Index)
+	{
+		const FChunk& Previous = Chunks[Index - 1];
+		const FChunk& Current = Chunks[Index];
+		if (Current.StartFrame != Previous.EndFrame + 1)
+		{
+			UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Chunks %d-%d and %d-%d don't line up, expected the second one to start at %d."),
+				Previous.StartFrame, Previous.EndFrame, Current.StartFrame, Current.EndFrame, Previous.EndFrame + 1);
+			if (!bInAllowGaps)
+			{
+				return false;
+			}
+		}
+	}
+
+	// Every output file name (render pass, output target) is stitched separately. The chunk directory can also hold
+	// the rendered frames (retained or not deleted), so only the fragments the chunk encode listed are picked up.
+	TArray<FString> VideoNames;
+	TArray<FString> AudioFiles;
+	for (const FChunk& Chunk : Chunks)
+	{
+		TArray<FString> FileNames;
+		IFileManager::Get().FindFiles(FileNames, *(Chunk.Directory / TEXT("*")), true, false);
+		FileNames.Sort();
+
+		TArray<FString> FragmentNames;
+		FString FragmentList;
+		if (FFileHelper::LoadFileToString(FragmentList, *(Chunk.Directory / FragmentListFileName)))
+		{
+			FragmentList.ParseIntoArrayLines(FragmentNames);
+		}
+		else
+		{
+			for (const FString& FileName : FileNames)
+			{
+				if (FPaths::GetExtension(FileName).Equals(EncoderSettings->OutputFileExtension, ESearchCase::IgnoreCase))
+				{
+					FragmentNames.Add(FileName);
+				}
+			}
+		}
+
+		for (const FString& FragmentName : FragmentNames)
+		{
+			VideoNames.AddUnique(FragmentName.TrimStartAndEnd());
+		}
+
+		for (const FString& FileName : FileNames)
+		{
+			if (FPaths::GetExtension(FileName).ToLower() == TEXT("wav"))
+			{
+				AudioFiles.Add(Chunk.Directory / FileName);
+			}
+		}
+	}
+
+	FString Executable = EncoderSettings->ExecutablePath.Replace(TEXT("\""), TEXT(""));
+	FPaths::NormalizeFilename(Executable);
+	IFileManager::Get().MakeDirectory(*InOutputDirectory, true);
+
+	const FGuid ListGuid = FGuid::NewGuid();
+	const FString AudioListPath = AudioFiles.Num() > 0 ? WriteConcatList(InOutputDirectory / ListGuid.ToString() + TEXT("_audio.txt"), AudioFiles) : FString();
+
+	bool bSucceeded = true;
+	for (const FString& VideoName : VideoNames)
+	{
+		TArray<FString> Fragments;
+		for (const FChunk& Chunk : Chunks)
+		{
+			const FString Fragment = Chunk.Directory / VideoName;
+			if (IFileManager::Get().FileExists(*Fragment))
+			{
+				Fragments.Add(Fragment);
+			}
+			else
+			{
+				UE_LOG(LogMovieRenderPipelineIO, Warning, TEXT("Chunk %d-%d has no '%s'."), Chunk.StartFrame, Chunk.EndFrame, *VideoName);
+			}
+		}
+
+		const FString VideoListPath = WriteConcatList(InOutputDirectory / ListGuid.ToString() + TEXT("_") + FPaths::GetBaseFilename(VideoName) + TEXT(".txt"), Fragments);
+		const FString OutputPath = InOutputDirectory / VideoName;
+
+		FString CommandLineArgs = FString::Printf(TEXT("-hide_banner -y -loglevel error -f concat -safe 0 -i \"%s\""), *VideoListPath);
+		if (AudioListPath.Len() > 0)
+		{
+			CommandLineArgs += FString::Printf(TEXT(" -f concat -safe 0 -i \"%s\" -map 0:v -map 1:a -c:v copy -c:a %s"), *AudioListPath, *EncoderSettings->AudioCodec);
+		}
+		else
+		{
+			CommandLineArgs += TEXT(" -map 0:v -c copy");
+		}
+		CommandLineArgs += FString::Printf(TEXT(" \"%s\""), *OutputPath);
+		UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Stitch Command Line Arguments: %s"), *CommandLineArgs);
+
+		const double StartTime = FPlatformTime::Seconds();
+		int32 ReturnCode = -1;
+		FString StdOut;
+		FString StdErr;
+		const bool bLaunched = FPlatformProcess::ExecProcess(*Executable, *CommandLineArgs, &ReturnCode, &StdOut, &StdErr);
+		IFileManager::Get().Delete(*VideoListPath);
+
+		if (!bLaunched || ReturnCode != 0)
+		{
+			UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Stitching '%s' failed (%d): %s"), *VideoName, ReturnCode, *StdErr.TrimStartAndEnd());
+			bSucceeded = false;
+			continue;
+		}
+
+		UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Stitched %d fragments into '%s' in %.1fs."), Fragments.Num(), *OutputPath, FPlatformTime::Seconds() - StartTime);
+		OutOutputPaths.Add(OutputPath);
+	}
+
+	if (AudioListPath.Len() > 0)
+	{
+		IFileManager::Get().Delete(*AudioListPath);
+	}
+
+	return bSucceeded && OutOutputPaths.Num() > 0;
+}
@@ -1,5 +1,10 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 #include "MoviePipelineCustomEncoder.h"
+#include "MoviePipelineChunkStitcher.h"
+#include "MoviePipelineDetachedEncodes.h"
+#include "MoviePipelineEncoderPipeReader.h"
+#include "MoviePipelineIntermediateFileCleanup.h"
+#include "MoviePipelineRetainedFrames.h"
 #include "MoviePipelineCommandLineEncoderSettings.h"
 #include "MoviePipelineOutputSetting.h"
 #include "MovieRenderPipelineCoreModule.h"
@@ -19,38 +24,70 @@
 #include "GenericPlatform/GenericPlatformFile.h"
 #include "Internationalization/Text.h"
 
+#if PLATFORM_LINUX
+#include <stdio.h>
+#endif
+
 #include UE_INLINE_GENERATED_CPP_BY_NAME(MoviePipelineCustomEncoder)
 
 
 namespace
 {
-	bool TryExtractFrameCount(const FString& Line, int32& OutFrame)
+#if PLATFORM_LINUX
+	/** procfs files report a size of 0, so they are read into a fixed buffer instead of going through FFileHelper. */
+	FString ReadProcFile(const uint32 InProcessId, const char* InName)
 	{
-		const int32 FrameTokenIndex = Line.Find(TEXT("frame="), ESearchCase::IgnoreCase, ESearchDir::FromStart);
-		if (FrameTokenIndex == INDEX_NONE)
+		char Path[64];
+		FCStringAnsi::Snprintf(Path, sizeof(Path), "/proc/%u/%s", InProcessId, InName);
+		FILE* File = fopen(Path, "r");
+		if (!File)
 		{
-			return false;
+			return FString();
 		}
 
-		int32 Index = FrameTokenIndex + 6;
-		while (Index < Line.Len() && FChar::IsWhitespace(Line[Index]))
-		{
-			++Index;
-		}
+		char Buffer[4096];
+		const size_t NumRead = fread(Buffer, 1, sizeof(Buffer) - 1, File);
+		fclose(File);
+		Buffer[NumRead] = '\0';
+		return FString(ANSI_TO_TCHAR(Buffer));
+	}
 
-		const int32 StartIndex = Index;
-		while (Index < Line.Len() && FChar::IsDigit(Line[Index]))
+	/** Value of a "<Key>: <number>" line times InUnit, -1 if there is no such line. */
+	int64 FindProcField(const FString& InText, const TCHAR* InKey, const int64 InUnit)
+	{
+		TArray<FString> Lines;
+		InText.ParseIntoArrayLines(Lines);
+		for (const FString& Line : Lines)
 		{
-			++Index;
+			FString Key;
+			FString Value;
+			if (Line.Split(TEXT(":"), &Key, &Value) && Key == InKey)
+			{
+				return FCString::Atoi64(*Value.TrimStart()) * InUnit;
+			}
 		}
+		return -1;
+	}
+#endif
 
-		if (StartIndex == Index)
+	/**
+	* The kernel drops a process's counters once it is reaped, which IsProcRunning does as soon as it sees the exit,
+	* so the usage is sampled every tick before that. Only the reads after the last sample are missed.
+	*/
+	void SampleEncoderProcessUsage(const uint32 InProcessId, FMoviePipelineEncoderProgress& InOutProgress)
+	{
+#if PLATFORM_LINUX
+		if (InProcessId == 0)
 		{
-			return false;
+			return;
 		}
 
-		OutFrame = FCString::Atoi(*Line.Mid(StartIndex, Index - StartIndex));
-		return true;;
+		InOutProgress.PeakResidentBytes = FMath::Max(InOutProgress.PeakResidentBytes, FindProcField(ReadProcFile(InProcessId, "status"), TEXT("VmHWM"), 1024));
+
+		const FString IoText = ReadProcFile(InProcessId, "io");
+		InOutProgress.ReadBytes = FMath::Max(InOutProgress.ReadBytes, FindProcField(IoText, TEXT("rchar"), 1));
+		InOutProgress.StorageReadBytes = FMath::Max(InOutProgress.StorageReadBytes, FindProcField(IoText, TEXT("read_bytes"), 1));
+#endif
 	}
 
 	FString MakeEtaStatusMessage(const double InRemainingSeconds)
@@ -80,7 +117,116 @@ namespace
 
 		return FString::Printf(TEXT("Encoding ETA: %d"), TotalSeconds);
 	}
-	
+
+	/**
+	* Command line used when output targets are defined and the Project Settings format can't be split, the outputs share
+	* a single decode through a split filter graph.
+	*/
+	const TCHAR* MultiOutputCommandLineFormat = TEXT("-hide_banner -y -loglevel error {AdditionalLocalArgs} {VideoInputs} {AudioInputs} -filter_complex \"{FilterGraph}\"{Outputs}");
+
+	/** Arguments for each output target of the built-in multi-output command line. */
+	const TCHAR* OutputTargetStringFormat = TEXT("-map \"[{OutputLabel}]\"{AudioMaps} -acodec {AudioCodec} -vcodec {VideoCodec} {Quality} {OutputArgs} \"{OutputPath}\"");
+
+	/**
+	* Splits a single output command line format at {AudioInputs} into the multi-output command line and the arguments
+	* repeated per output target, so the global, input and output options configured in it are kept.
+	*/
+	bool MakeMultiOutputFormats(const FString& InCommandLineFormat, FString& OutCommandLineFormat, FString& OutTargetFormat)
+	{
+		const FString InputsToken = TEXT("{AudioInputs}");
+		const int32 InputsEnd = InCommandLineFormat.Find(InputsToken);
+		if (InputsEnd == INDEX_NONE)
+		{
+			return false;
+		}
+
+		FString OutputPart = InCommandLineFormat.Mid(InputsEnd + InputsToken.Len()).TrimStartAndEnd();
+		const TCHAR* QuotedOutputPath = TEXT("\"{OutputPath}\"");
+		const TCHAR* OutputPath = OutputPart.Contains(QuotedOutputPath) ? QuotedOutputPath : TEXT("{OutputPath}");
+		if (!OutputPart.Contains(OutputPath))
+		{
+			return false;
+		}
+
+		OutCommandLineFormat = InCommandLineFormat.Left(InputsEnd + InputsToken.Len()) + TEXT(" -filter_complex \"{FilterGraph}\"{Outputs}");
+		OutTargetFormat = TEXT("-map \"[{OutputLabel}]\"{AudioMaps} ") + OutputPart.Replace(OutputPath, *(FString(TEXT("{OutputArgs} ")) + OutputPath));
+		return true;
+	}
+
+	/** Placeholder in a job's command line that is replaced by the preset chosen for the time budget. */
+	const TCHAR* EncodePresetToken = TEXT("{EncodePreset}");
+
+	/**
+	* Rough speed gained per step of the preset ladder (x264/x265 presets are about this far apart). Only used to pick how far
+	* to jump, the speed is measured again after every restart.
+	*/
+	constexpr double EncodePresetStepSpeedup = 1.5;
+
+	/**
+	* Checks whether the files are "<prefix><number>.<ext>" with one prefix, one extension, fixed-width numbers
+	* and no gaps, in the order given. If so, returns the printf-style image2 pattern and the first number.
+	*/
+	bool TryMakeImageSequencePattern(const TArray<FString>& InFiles, FString& OutPattern, int32& OutStartNumber)
+	{
+		if (InFiles.Num() == 0)
+		{
+			return false;
+		}
+
+		FString SequencePrefix;
+		FString SequenceExtension;
+		int32 SequenceDigits = 0;
+		int32 ExpectedNumber = 0;
+
+		for (int32 Index = 0; Index < InFiles.Num(); ++Index)
+		{
+			const FString& File = InFiles[Index];
+			int32 ExtensionIndex = INDEX_NONE;
+			if (!File.FindLastChar(TEXT('.'), ExtensionIndex))
+			{
+				return false;
+			}
+
+			int32 DigitsStart = ExtensionIndex;
+			while (DigitsStart > 0 && FChar::IsDigit(File[DigitsStart - 1]))
+			{
+				--DigitsStart;
+			}
+
+			const int32 NumDigits = ExtensionIndex - DigitsStart;
+			if (NumDigits == 0 || NumDigits > 9)
+			{
+				return false;
+			}
+
+			const FStringView Prefix(*File, DigitsStart);
+			const FStringView Extension(*File + ExtensionIndex + 1, File.Len() - ExtensionIndex - 1);
+			const int32 Number = FCString::Atoi(*File.Mid(DigitsStart, NumDigits));
+
+			if (Index == 0)
+			{
+				SequencePrefix = FString(Prefix);
+				SequenceExtension = FString(Extension);
+				SequenceDigits = NumDigits;
+				OutStartNumber = Number;
+				ExpectedNumber = Number;
+			}
+			else if (NumDigits != SequenceDigits || !Prefix.Equals(SequencePrefix) || !Extension.Equals(SequenceExtension))
+			{
+				return false;
+			}
+
+			if (Number != ExpectedNumber)
+			{
+				return false;
+			}
+			++ExpectedNumber;
+		}
+
+		// A literal '%' in the path has to be escaped for the image2 demuxer.
+		OutPattern = SequencePrefix.Replace(TEXT("%"), TEXT("%%")) + FString::Printf(TEXT("%%0%dd."), SequenceDigits) + SequenceExtension;
+		return true;
+	}
 }
 
 // Forward Declare
@@ -100,6 +246,15 @@ UMoviePipelineCustomEncoder::UMoviePipelineCustomEncoder()
 	bDeleteSourceFiles = false;
 	bSkipEncodeOnRenderCanceled = true;
 	bWriteEachFrameDuration = true;
+	bUseImageSequencePattern = true;
+	bEncodeAsChunk = false;
+	ChunkGopSize = 0;
+	bRetainSourceFrames = false;
+	SourceFrameRetentionHours = 72.f;
+	bUseEncodeTimeBudget = false;
+	EncodeTimeBudgetSeconds = 3600.f;
+	EncodeBudgetProbeFrames = 300;
+	EncodeBudgetPresetLadder = { TEXT("veryslow"), TEXT("slower"), TEXT("slow"), TEXT("medium"), TEXT("fast"), TEXT("faster"), TEXT("veryfast"), TEXT("superfast"), TEXT("ultrafast") };
 }
 
 bool UMoviePipelineCustomEncoder::HasFinishedExportingImpl()
@@ -108,7 +263,36 @@ bool UMoviePipelineCustomEncoder::HasFinishedExportingImpl()
 	// manually canceling a job stops ticking the engine and repeatedly calls HasFinishedExportingImpl
 	OnTick();
 
-	return ActiveEncodeJobs.Num() == 0;
+	// Once every encode is launched the processes no longer need the pipeline, let them finish on their own so the
+	// worker can move on. Canceled renders keep the regular path, which may terminate the encodes.
+	UMoviePipeline* Pipeline = GetPipeline();
+	if (FMoviePipelineDetachedEncodes::IsEnabled() && ActiveEncodeJobs.Num() > 0 && PendingEncodeJobs.Num() == 0
+		&& !(Pipeline && Pipeline->IsShutdownRequested()))
+	{
+		DetachActiveEncodes();
+	}
+
+	return ActiveEncodeJobs.Num() == 0 && PendingEncodeJobs.Num() == 0;
+}
+
+void UMoviePipelineCustomEncoder::DetachActiveEncodes()
+{
+	// A copy carries the settings OnTick needs (source deletion, time budget) without tying up the pipeline's config
+	UMoviePipelineCustomEncoder* DetachedEncoder = DuplicateObject<UMoviePipelineCustomEncoder>(this, GetTransientPackage());
+	DetachedEncoder->ActiveEncodeJobs = MoveTemp(ActiveEncodeJobs);
+	DetachedEncoder->AudioIntermediateRefCounts = MoveTemp(AudioIntermediateRefCounts);
+	DetachedEncoder->bEncodeFailed = bEncodeFailed;
+	ActiveEncodeJobs.Reset();
+	AudioIntermediateRefCounts.Reset();
+
+	FString JobId;
+	UMoviePipeline* Pipeline = GetPipeline();
+	if (const UMoviePipelineExecutorJob* Job = Pipeline ? Pipeline->GetCurrentJob() : nullptr)
+	{
+		JobId = Job->UserData.Len() > 0 ? Job->UserData : Job->JobName;
+	}
+
+	FMoviePipelineDetachedEncodes::Adopt(DetachedEncoder, JobId, PipelineOutputPaths);
 }
 
 void UMoviePipelineCustomEncoder::BeginExportImpl()
@@ -170,19 +354,8 @@ void UMoviePipelineCustomEncoder::StartEncodingProcess(TArray<FMoviePipelineShot
 	/** We produce one file per render pass we detect */
 	TMap<FMoviePipelinePassIdentifier, FEncoderParams> RenderPasses;
 	
-	// The path shouldn't have quotes on it as it's already kept as a separate argument right up until creating the process, at which point
-	// the platform puts quotes around the FString if needed.
-	FString ExecutablePathNoQuotes = EncoderSettings->ExecutablePath.Replace(TEXT("\""), TEXT(""));
-	FPaths::NormalizeFilename(ExecutablePathNoQuotes);
-	
-	FStringFormatNamedArguments SharedArguments;
-	SharedArguments.Add(TEXT("Executable"), ExecutablePathNoQuotes);
-	SharedArguments.Add(TEXT("AudioCodec"), EncoderSettings->AudioCodec);
-	SharedArguments.Add(TEXT("VideoCodec"), EncoderSettings->VideoCodec);
 	FFrameRate RenderFrameRate = GetPipeline()->GetPipelinePrimaryConfig()->GetEffectiveFrameRate(GetPipeline()->GetTargetSequence());
-	SharedArguments.Add(TEXT("FrameRate"), RenderFrameRate.AsDecimal());
-	SharedArguments.Add(TEXT("AdditionalLocalArgs"), AdditionalCommandLineArgs);
-	SharedArguments.Add(TEXT("Quality"), GetQualitySettingString());
+	FStringFormatNamedArguments SharedArguments = MakeSharedArguments(RenderFrameRate.AsDecimal());
 
 	for (FMoviePipelineShotOutputData& Data : InOutData)
 	{
@@ -231,12 +404,57 @@ void UMoviePipelineCustomEncoder::StartEncodingProcess(TArray<FMoviePipelineShot
 		// because the files will be deleted out from underneath at a random point, so don't want the scripting
 		// layer to think they can rely on them actually existing. If scripting layer really needs source files,
 		// they need to not use the Command Line Encoder setting and instead roll their own.
-		if (bDeleteSourceFiles)
+		if (ShouldDeleteSourceFiles())
 		{
 			Data.RenderPassData.Reset();
 		}
 	}
 
+	// Frames kept by earlier jobs are dropped once their retention window passed. Scanning the whole render root
+	// can take a while on a network share, so it runs on a background task.
+	if (bRetainSourceFrames)
+	{
+		FMoviePipelineRetainedFrames::DeleteExpiredAsync(FMoviePipelineRetainedFrames::GetDefaultSweepDirectory());
+	}
+
+	// With more than one render pass the same audio would be decoded and encoded once per pass. Encode it once
+	// into an intermediate instead and let every pass stream-copy it once that's done.
+	TMap<FMoviePipelinePassIdentifier, FGuid> AudioJobIdsByPass;
+	if (RenderPasses.Num() > 1 && !bEncodeAsChunk)
+	{
+		TMap<FString, FGuid> AudioJobIdsByFileList;
+		for (const TTuple<FMoviePipelinePassIdentifier, FEncoderParams>& RenderPass : RenderPasses)
+		{
+			const TArray<FString>* AudioFiles = RenderPass.Value.FilesByExtensionType.Find(TEXT("wav"));
+			if (!AudioFiles || AudioFiles->Num() == 0)
+			{
+				continue;
+			}
+
+			const FString FileListKey = FString::Join(*AudioFiles, TEXT("|"));
+			if (const FGuid* ExistingJobId = AudioJobIdsByFileList.Find(FileListKey))
+			{
+				AudioJobIdsByPass.Add(RenderPass.Key, *ExistingJobId);
+				continue;
+			}
+
+			const FGuid AudioJobId = FGuid::NewGuid();
+			FString IntermediatePath;
+			{
+				FMoviePipelineFormatArgs FinalFormatArgs;
+				TMap<FString, FString> FormatOverrides;
+				FormatOverrides.Add(TEXT("ext"), TEXT("mka"));
+				GetPipeline()->ResolveFilenameFormatArguments(OutputSetting->OutputDirectory.Path / AudioJobId.ToString() + TEXT("_audio"), FormatOverrides, IntermediatePath, FinalFormatArgs);
+			}
+
+			if (LaunchAudioPreEncode(AudioJobId, *AudioFiles, IntermediatePath, SharedArguments))
+			{
+				AudioJobIdsByFileList.Add(FileListKey, AudioJobId);
+				AudioJobIdsByPass.Add(RenderPass.Key, AudioJobId);
+			}
+		}
+	}
+
 	for (TTuple<FMoviePipelinePassIdentifier, FEncoderParams>& RenderPass : RenderPasses)
 	{
 		// Copy the shared arguments into our render pass
@@ -266,26 +484,55 @@ void UMoviePipelineCustomEncoder::StartEncodingProcess(TArray<FMoviePipelineShot
 			FileNameFormatString.ReplaceInline(TEXT("{version}"), *FString::Printf(TEXT("v%0*d"), 3, VersionNumber));
 		}
 
-		FMoviePipelineFormatArgs FinalFormatArgs;
+		auto ResolveOutputPath = [&](const FString& InFormatString, const TMap<FString, FString>& InFormatOverrides)
+		{
+			FMoviePipelineFormatArgs FinalFormatArgs;
 
-		FString FinalFilePath;
-		GetPipeline()->ResolveFilenameFormatArguments(FileNameFormatString, FormatOverrides, FinalFilePath, FinalFormatArgs);
+			FString FinalFilePath;
+			GetPipeline()->ResolveFilenameFormatArguments(InFormatString, InFormatOverrides, FinalFilePath, FinalFormatArgs);
 
-		if (FPaths::IsRelative(FinalFilePath))
-		{
-			FinalFilePath = FPaths::ConvertRelativePathToFull(FinalFilePath);
-		}
+			if (FPaths::IsRelative(FinalFilePath))
+			{
+				FinalFilePath = FPaths::ConvertRelativePathToFull(FinalFilePath);
+			}
 
-		FPaths::NormalizeFilename(FinalFilePath);
-		FPaths::CollapseRelativeDirectories(FinalFilePath);
+			FPaths::NormalizeFilename(FinalFilePath);
+			FPaths::CollapseRelativeDirectories(FinalFilePath);
 
-		FString FinalFileDirectory = FPaths::GetPath(FinalFilePath);
+			FString FinalFileDirectory = FPaths::GetPath(FinalFilePath);
 
-		// Ensure the output directory is created
-		IPlatformFile& FileManager = FPlatformFileManager::Get().GetPlatformFile();
-		if (!FileManager.CreateDirectoryTree(*FinalFileDirectory))
+			// Ensure the output directory is created
+			IPlatformFile& FileManager = FPlatformFileManager::Get().GetPlatformFile();
+			if (!FileManager.CreateDirectoryTree(*FinalFileDirectory))
+			{
+				UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Failed to create directory for output path '%s'"), *FinalFileDirectory);
+			}
+
+			return FinalFilePath;
+		};
+
+		TArray<FString> FinalFilePaths;
+		if (OutputTargets.Num() == 0)
 		{
-			UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Failed to create directory for output path '%s'"), *FinalFileDirectory);
+			FinalFilePaths.Add(ResolveOutputPath(FileNameFormatString, FormatOverrides));
+		}
+		else
+		{
+			// Every target needs its own file, so make sure the name differs even if the format string doesn't ask for it.
+			const FString TargetFormatString = FileNameFormatString.Contains(TEXT("{output_target}")) ? FileNameFormatString : FileNameFormatString + TEXT("_{output_target}");
+			for (int32 TargetIndex = 0; TargetIndex < OutputTargets.Num(); ++TargetIndex)
+			{
+				const FMoviePipelineEncoderOutputTarget& Target = OutputTargets[TargetIndex];
+
+				TMap<FString, FString> TargetFormatOverrides = FormatOverrides;
+				TargetFormatOverrides.Add(TEXT("output_target"), Target.Name.Len() > 0 ? Target.Name : FString::FromInt(TargetIndex));
+				if (Target.FileExtension.Len() > 0)
+				{
+					TargetFormatOverrides.Add(TEXT("ext"), Target.FileExtension);
+				}
+
+				FinalFilePaths.Add(ResolveOutputPath(TargetFormatString, TargetFormatOverrides));
+			}
 		}
 
 		// Manipulate the in/out data in case scripting tries to get access to the files. It's not a perfect solution
@@ -298,18 +545,221 @@ void UMoviePipelineCustomEncoder::StartEncodingProcess(TArray<FMoviePipelineShot
 				continue;
 			}
 
-			Data.RenderPassData.FindOrAdd(FMoviePipelinePassIdentifier("CommandLineEncoder")).FilePaths.Add(FinalFilePath);
+			Data.RenderPassData.FindOrAdd(FMoviePipelinePassIdentifier("CommandLineEncoder")).FilePaths.Append(FinalFilePaths);
 		}
 		
-		RenderPass.Value.NamedArguments.Add(TEXT("OutputPath"), FinalFilePath);
+		RenderPass.Value.NamedArguments.Add(TEXT("OutputPath"), FinalFilePaths[0]);
+		RenderPass.Value.OutputPaths = MoveTemp(FinalFilePaths);
+		PipelineOutputPaths.Append(RenderPass.Value.OutputPaths);
+
+		if (bEncodeAsChunk)
+		{
+			MoveChunkAudio(RenderPass.Value);
+		}
+
+		if (bRetainSourceFrames)
+		{
+			WriteRetainedFramesManifest(RenderPass.Value);
+		}
+
+		if (const FGuid* AudioJobId = AudioJobIdsByPass.Find(RenderPass.Key))
+		{
+			FPendingEncode& PendingEncode = PendingEncodeJobs.AddDefaulted_GetRef();
+			PendingEncode.Params = RenderPass.Value;
+			PendingEncode.AudioJobId = *AudioJobId;
+			continue;
+		}
+
 		LaunchEncoder(RenderPass.Value);
 	}
+
+	if (bEncodeAsChunk)
+	{
+		WriteChunkFragmentLists();
+	}
 }
 
-void UMoviePipelineCustomEncoder::LaunchEncoder(const FEncoderParams& InParams)
+FStringFormatNamedArguments UMoviePipelineCustomEncoder::MakeSharedArguments(const double InFrameRate) const
+{
+	const UMoviePipelineCommandLineEncoderSettings* EncoderSettings = GetDefault<UMoviePipelineCommandLineEncoderSettings>();
+
+	// The path shouldn't have quotes on it as it's already kept as a separate argument right up until creating the process, at which point
+	// the platform puts quotes around the FString if needed.
+	FString ExecutablePathNoQuotes = EncoderSettings->ExecutablePath.Replace(TEXT("\""), TEXT(""));
+	FPaths::NormalizeFilename(ExecutablePathNoQuotes);
+	
+	FStringFormatNamedArguments SharedArguments;
+	SharedArguments.Add(TEXT("Executable"), ExecutablePathNoQuotes);
+	SharedArguments.Add(TEXT("AudioCodec"), EncoderSettings->AudioCodec);
+	SharedArguments.Add(TEXT("VideoCodec"), EncoderSettings->VideoCodec);
+	SharedArguments.Add(TEXT("FrameRate"), InFrameRate);
+	SharedArguments.Add(TEXT("AdditionalLocalArgs"), AdditionalCommandLineArgs);
+	SharedArguments.Add(TEXT("Quality"), GetQualitySettingString());
+	return SharedArguments;
+}
+
+bool UMoviePipelineCustomEncoder::StartStandaloneEncode(const FMoviePipelineStandaloneEncodeRequest& InRequest, TArray<FString>& OutOutputPaths)
 {
+	const UMoviePipelineCommandLineEncoderSettings* EncoderSettings = GetDefault<UMoviePipelineCommandLineEncoderSettings>();
+
+	TArray<FText> ErrorTexts = UE::MoviePipeline::GetErrorTexts();
+	for (const FText& ErrorText : ErrorTexts)
+	{
+		UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("%s"), *ErrorText.ToString());
+	}
+	if (ErrorTexts.Num() > 0)
+	{
+		return false;
+	}
+
+	if (InRequest.VideoFiles.Num() == 0 || InRequest.OutputPathNoExtension.IsEmpty() || InRequest.FrameRate <= 0.0)
+	{
+		UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Standalone encode needs frames, an output path and a frame rate."));
+		return false;
+	}
+
+	FEncoderParams Params;
+	Params.NamedArguments = MakeSharedArguments(InRequest.FrameRate);
+	Params.ExpectedFrameCount = InRequest.VideoFiles.Num();
+	Params.WorkingDirectory = InRequest.WorkingDirectory.Len() > 0 ? InRequest.WorkingDirectory : FPaths::GetPath(InRequest.OutputPathNoExtension);
+
+	for (const FString& FilePath : InRequest.VideoFiles)
+	{
+		Params.FilesByExtensionType.FindOrAdd(FPaths::GetExtension(FilePath)).Add(FilePath);
+	}
+	for (const FString& FilePath : InRequest.AudioFiles)
+	{
+		Params.FilesByExtensionType.FindOrAdd(TEXT("wav")).Add(FilePath);
+	}
+
+	// Same naming as a pipeline encode whose format string has no {output_target}.
+	if (OutputTargets.Num() == 0)
+	{
+		Params.OutputPaths.Add(InRequest.OutputPathNoExtension + TEXT(".") + EncoderSettings->OutputFileExtension);
+	}
+	else
+	{
+		for (int32 TargetIndex = 0; TargetIndex < OutputTargets.Num(); ++TargetIndex)
+		{
+			const FMoviePipelineEncoderOutputTarget& Target = OutputTargets[TargetIndex];
+			const FString TargetName = Target.Name.Len() > 0 ? Target.Name : FString::FromInt(TargetIndex);
+			const FString Extension = Target.FileExtension.Len() > 0 ? Target.FileExtension : EncoderSettings->OutputFileExtension;
+			Params.OutputPaths.Add(InRequest.OutputPathNoExtension + TEXT("_") + TargetName + TEXT(".") + Extension);
+		}
+	}
+
+	IPlatformFile& FileManager = FPlatformFileManager::Get().GetPlatformFile();
+	for (FString& OutputPath : Params.OutputPaths)
+	{
+		FPaths::NormalizeFilename(OutputPath);
+		if (!FileManager.CreateDirectoryTree(*FPaths::GetPath(OutputPath)))
+		{
+			UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Failed to create directory for output path '%s'"), *OutputPath);
+			return false;
+		}
+	}
+	FileManager.CreateDirectoryTree(*Params.WorkingDirectory);
+
+	Params.NamedArguments.Add(TEXT("OutputPath"), Params.OutputPaths[0]);
+
+	const int32 NumJobsBefore = ActiveEncodeJobs.Num();
+	LaunchEncoder(Params);
+	if (ActiveEncodeJobs.Num() == NumJobsBefore)
+	{
+		return false;
+	}
+
+	OutOutputPaths = Params.OutputPaths;
+	return true;
+}
+
+bool UMoviePipelineCustomEncoder::EncodeStandaloneBlocking(const FMoviePipelineStandaloneEncodeRequest& InRequest, TArray<FString>& OutOutputPaths)
+{
+	bEncodeFailed = false;
+	if (!StartStandaloneEncode(InRequest, OutOutputPaths))
+	{
+		return false;
+	}
+
+	while (TickStandaloneEncode())
+	{
+		FPlatformProcess::Sleep(0.01f);
+	}
+
+	// A failing encoder can still leave a partial file behind, so both its exit code and the outputs count.
+	if (HasEncodeFailed())
+	{
+		return false;
+	}
+	for (const FString& OutputPath : OutOutputPaths)
+	{
+		if (IFileManager::Get().FileSize(*OutputPath) <= 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void UMoviePipelineCustomEncoder::WriteRetainedFramesManifest(const FEncoderParams& InParams) const
+{
+	FMoviePipelineStandaloneEncodeRequest Request;
+	Request.FrameRate = InParams.NamedArguments[TEXT("FrameRate")].DoubleValue;
+	Request.OutputPathNoExtension = FPaths::GetPath(InParams.OutputPaths[0]) / FPaths::GetBaseFilename(InParams.OutputPaths[0]);
+	for (const TTuple<FString, TArray<FString>>& Pair : InParams.FilesByExtensionType)
+	{
+		(Pair.Key == TEXT("wav") ? Request.AudioFiles : Request.VideoFiles).Append(Pair.Value);
+	}
+
+	FMoviePipelineRetainedFrames::WriteManifest(Request, SourceFrameRetentionHours);
+}
+
+bool UMoviePipelineCustomEncoder::TickStandaloneEncode()
+{
+	OnTick();
+	return ActiveEncodeJobs.Num() > 0 || PendingEncodeJobs.Num() > 0;
+}
+
+FString UMoviePipelineCustomEncoder::ResolveGeneratedFilePath(const FEncoderParams& InParams, const FString& InBaseName, const FString& InExtension) const
+{
+	if (InParams.WorkingDirectory.Len() > 0)
+	{
+		return InParams.WorkingDirectory / InBaseName + TEXT(".") + InExtension;
+	}
+
 	UMoviePipelineOutputSetting* OutputSetting = GetPipeline()->GetPipelinePrimaryConfig()->FindSetting<UMoviePipelineOutputSetting>();
 
+	FMoviePipelineFormatArgs FinalFormatArgs;
+	FString FinalFilePath;
+	TMap<FString, FString> FormatOverrides;
+	FormatOverrides.Add(TEXT("ext"), InExtension);
+
+	GetPipeline()->ResolveFilenameFormatArguments(OutputSetting->OutputDirectory.Path / InBaseName, FormatOverrides, FinalFilePath, FinalFormatArgs);
+	return FinalFilePath;
+}
+
+FString UMoviePipelineCustomEncoder::GetImageSequenceInputStringFormat() const
+{
+	if (ImageSequenceInputStringFormat.Len() > 0)
+	{
+		return ImageSequenceInputStringFormat;
+	}
+
+	// The list's frame durations are replaced by -framerate, everything else the project configured is kept
+	const FString& VideoInputStringFormat = GetDefault<UMoviePipelineCommandLineEncoderSettings>()->VideoInputStringFormat;
+	if (!VideoInputStringFormat.Contains(TEXT("-f concat")))
+	{
+		UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Video Input String Format '%s' doesn't use the concat demuxer, set ImageSequenceInputStringFormat to use the image sequence pattern."), *VideoInputStringFormat);
+		return FString();
+	}
+
+	return VideoInputStringFormat
+		.Replace(TEXT("-f concat"), TEXT("-f image2 -pattern_type sequence -framerate {FrameRate} -start_number {StartNumber}"))
+		.Replace(TEXT(" -safe 0"), TEXT(""));
+}
+
+void UMoviePipelineCustomEncoder::LaunchEncoder(const FEncoderParams& InParams)
+{
 	// Generate a text file for each input type which lists the files for that input type. We generate a FGuid in case there are
 	// multiple encode jobs going at once.
 	TStringBuilder<64> StringBuilder;
@@ -319,19 +769,34 @@ void UMoviePipelineCustomEncoder::LaunchEncoder(const FEncoderParams& InParams)
 	double InFrameRate = InParams.NamedArguments[TEXT("FrameRate")].DoubleValue;
 	double FrameRateAsDuration = 1.0 / InFrameRate;
 
+	// Image sequences that are numbered without gaps are passed as an image2 pattern, which saves writing a
+	// line per frame and lets the encoder skip probing every file. The concat list remains the fallback.
+	FString PatternVideoInputArg;
+	const FString PatternInputStringFormat = bUseImageSequencePattern ? GetImageSequenceInputStringFormat() : FString();
+
 	for (const TTuple<FString, TArray<FString>>& Pair : InParams.FilesByExtensionType)
 	{
-		FGuid FileGuid = FGuid::NewGuid();
-		FString FilePath = OutputSetting->OutputDirectory.Path / FileGuid.ToString() + TEXT("_input");
+		if (Pair.Key != TEXT("wav") && PatternInputStringFormat.Len() > 0)
+		{
+			FString Pattern;
+			int32 StartNumber = 0;
+			if (TryMakeImageSequencePattern(Pair.Value, Pattern, StartNumber))
+			{
+				FStringFormatNamedArguments NamedArgs;
+				NamedArgs.Add(TEXT("InputFile"), Pattern);
+				NamedArgs.Add(TEXT("StartNumber"), StartNumber);
+				NamedArgs.Add(TEXT("FrameRate"), InParams.NamedArguments[TEXT("FrameRate")]);
 
-		FMoviePipelineFormatArgs FinalFormatArgs;
+				PatternVideoInputArg += TEXT(" ") + FString::Format(*PatternInputStringFormat, NamedArgs);
+				UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Using image sequence pattern '%s' starting at %d for %d files."), *Pattern, StartNumber, Pair.Value.Num());
+				continue;
+			}
 
-		FString FinalFilePath;
-		TMap<FString, FString> FormatOverrides;
-		FormatOverrides.Add(TEXT("ext"), TEXT("txt"));
+			UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("'%s' files are not a contiguous numbered sequence, falling back to a file list."), *Pair.Key);
+		}
 
-		GetPipeline()->ResolveFilenameFormatArguments(FilePath, FormatOverrides, FinalFilePath, FinalFormatArgs);
-		
+		FGuid FileGuid = FGuid::NewGuid();
+		const FString FinalFilePath = ResolveGeneratedFilePath(InParams, FileGuid.ToString() + TEXT("_input"), TEXT("txt"));
 
 		UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Generated Path '%s' for input data."), *FinalFilePath);
 		StringBuilder.Reset();
@@ -364,7 +829,7 @@ void UMoviePipelineCustomEncoder::LaunchEncoder(const FEncoderParams& InParams)
 	const UMoviePipelineCommandLineEncoderSettings* EncoderSettings = GetDefault<UMoviePipelineCommandLineEncoderSettings>();
 	FStringFormatNamedArguments FinalNamedArgs = InParams.NamedArguments;
 	
-	FString VideoInputArg;
+	FString VideoInputArg = PatternVideoInputArg;
 	FString AudioInputArg;
 
 	for (const FString& FilePath : VideoInputs)
@@ -384,45 +849,138 @@ void UMoviePipelineCustomEncoder::LaunchEncoder(const FEncoderParams& InParams)
 		AudioInputArg += TEXT(" ") + FString::Format(*EncoderSettings->AudioInputStringFormat, NamedArgs);
 	}
 
+	// Audio that was encoded once for all render passes only needs to be copied into this output.
+	int32 NumAudioInputs = AudioInputs.Num();
+	if (InParams.AudioIntermediatePath.Len() > 0)
+	{
+		AudioInputArg += FString::Printf(TEXT(" -i \"%s\""), *InParams.AudioIntermediatePath);
+		FinalNamedArgs.Add(TEXT("AudioCodec"), TEXT("copy"));
+		++NumAudioInputs;
+	}
+
 	FinalNamedArgs.Add(TEXT("VideoInputs"), VideoInputArg);
 	FinalNamedArgs.Add(TEXT("AudioInputs"), AudioInputArg);
-	FString CommandLineArgs = FString::Format(*EncoderSettings->CommandLineFormat, FinalNamedArgs);
-	UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Final Command Line Arguments: %s"), *CommandLineArgs);
 
-	const bool bLaunchDetached = false;
-	const bool bLaunchHidden = true;
-	const bool bLaunchReallyHidden = bLaunchHidden;
+	// Under a time budget the quality arguments get a placeholder, so the job can be restarted with a faster preset
+	// without rebuilding the command line. Short encodes finish before the probe would, there's nothing to adjust.
+	const bool bApplyTimeBudget = bUseEncodeTimeBudget && EncodeBudgetPresetLadder.Num() > 0 && InParams.ExpectedFrameCount > EncodeBudgetProbeFrames;
+	const FString PresetPlaceholder = bApplyTimeBudget ? EncodePresetToken : TEXT("");
+	int32 InitialPresetIndex = INDEX_NONE;
+
+	FString CommandLineArgs;
+	if (OutputTargets.Num() == 0)
+	{
+		const FString QualityString = GetQualitySettingString();
+		InitialPresetIndex = FindPresetInLadder(QualityString);
+		FinalNamedArgs.Add(TEXT("Quality"), QualityString + GetChunkEncodeArgs(InFrameRate, EncoderSettings->OutputFileExtension) + PresetPlaceholder);
+		CommandLineArgs = FString::Format(*EncoderSettings->CommandLineFormat, FinalNamedArgs);
+	}
+	else
+	{
+		// Decode the frames once and split them into one branch per output target, scaling where requested. Only one
+		// input can feed the split, encoding just the first would silently produce incomplete videos.
+		const int32 NumVideoInputs = VideoInputs.Num() + (PatternVideoInputArg.IsEmpty() ? 0 : 1);
+		if (NumVideoInputs > 1)
+		{
+			UE_LOG(LogMovieRenderPipeline, Error, TEXT("Output targets need a single video input per render pass, got %d (e.g. mixed file types). Not encoding '%s'."),
+				NumVideoInputs, InParams.OutputPaths.Num() > 0 ? *InParams.OutputPaths[0] : TEXT(""));
+			bEncodeFailed = true;
+			if (UMoviePipeline* Pipeline = GetPipeline())
+			{
+				Pipeline->Shutdown(true);
+			}
+			return;
+		}
+
+		FString CommandLineFormat;
+		FString TargetFormat;
+		if (!MakeMultiOutputFormats(EncoderSettings->CommandLineFormat, CommandLineFormat, TargetFormat))
+		{
+			UE_LOG(LogMovieRenderPipelineIO, Warning, TEXT("Command Line Format '%s' has no {AudioInputs} followed by {OutputPath}, using the built-in command line for the output targets."),
+				*EncoderSettings->CommandLineFormat);
+			CommandLineFormat = MultiOutputCommandLineFormat;
+			TargetFormat = OutputTargetStringFormat;
+		}
+
+		FString AudioMaps;
+		for (int32 AudioIndex = 0; AudioIndex < NumAudioInputs; ++AudioIndex)
+		{
+			AudioMaps += FString::Printf(TEXT(" -map %d:a"), NumVideoInputs + AudioIndex);
+		}
+
+		TStringBuilder<256> FilterGraph;
+		TStringBuilder<256> ScaleFilters;
+		FilterGraph.Appendf(TEXT("[0:v]split=%d"), OutputTargets.Num());
+
+		FString Outputs;
+		for (int32 TargetIndex = 0; TargetIndex < OutputTargets.Num(); ++TargetIndex)
+		{
+			const FMoviePipelineEncoderOutputTarget& Target = OutputTargets[TargetIndex];
+			const FString OutputLabel = FString::Printf(TEXT("v%d"), TargetIndex);
+
+			if (FMath::IsNearlyEqual(Target.ResolutionScale, 1.f) || Target.ResolutionScale <= 0.f)
+			{
+				FilterGraph.Appendf(TEXT("[%s]"), *OutputLabel);
+			}
+			else
+			{
+				// Keep dimensions even, most video codecs require it.
+				FilterGraph.Appendf(TEXT("[s%d]"), TargetIndex);
+				ScaleFilters.Appendf(TEXT(";[s%d]scale=trunc(iw*%f/2)*2:trunc(ih*%f/2)*2[%s]"), TargetIndex, Target.ResolutionScale, Target.ResolutionScale, *OutputLabel);
+			}
+
+			FStringFormatNamedArguments OutputNamedArgs = InParams.NamedArguments;
+			OutputNamedArgs.Add(TEXT("OutputLabel"), OutputLabel);
+			OutputNamedArgs.Add(TEXT("AudioMaps"), AudioMaps);
+			OutputNamedArgs.Add(TEXT("OutputArgs"), Target.AdditionalArgs);
+			const FString QualityString = GetQualitySettingString(Target.Quality);
+			const FString TargetExtension = Target.FileExtension.Len() > 0 ? Target.FileExtension : EncoderSettings->OutputFileExtension;
+			InitialPresetIndex = FMath::Max(InitialPresetIndex, FindPresetInLadder(QualityString));
+			OutputNamedArgs.Add(TEXT("Quality"), QualityString + GetChunkEncodeArgs(InFrameRate, TargetExtension) + PresetPlaceholder);
+			OutputNamedArgs.Add(TEXT("AudioCodec"), FinalNamedArgs[TEXT("AudioCodec")]);
+			OutputNamedArgs.Add(TEXT("OutputPath"), InParams.OutputPaths.IsValidIndex(TargetIndex) ? InParams.OutputPaths[TargetIndex] : FString());
+			if (Target.VideoCodec.Len() > 0)
+			{
+				OutputNamedArgs.Add(TEXT("VideoCodec"), Target.VideoCodec);
+			}
 
-	void* PipeRead = nullptr;
-	void* PipeWrite = nullptr;
-	int32 ReturnCode = -1;
+			Outputs += TEXT(" ") + FString::Format(*TargetFormat, OutputNamedArgs);
+		}
 
-	verify(FPlatformProcess::CreatePipe(PipeRead, PipeWrite));
+		FilterGraph.Append(ScaleFilters.ToView());
+		FinalNamedArgs.Add(TEXT("FilterGraph"), FilterGraph.ToString());
+		FinalNamedArgs.Add(TEXT("Outputs"), Outputs);
+		CommandLineArgs = FString::Format(*CommandLineFormat, FinalNamedArgs);
+	}
+	UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Final Command Line Arguments: %s"), *CommandLineArgs);
 
 	FString ExecutableArg = FString::Format(TEXT("{Executable}"), InParams.NamedArguments);
-	FProcHandle ProcessHandle = FPlatformProcess::CreateProc(*ExecutableArg, *CommandLineArgs, bLaunchDetached, bLaunchHidden, bLaunchReallyHidden, nullptr, 0, nullptr, PipeWrite, PipeRead);
-	if (ProcessHandle.IsValid())
+	FActiveJob NewJob;
+	if (StartEncoderProcess(ExecutableArg, CommandLineArgs.Replace(EncodePresetToken, TEXT("")), NewJob))
 	{
-		FActiveJob& NewJob = ActiveEncodeJobs.AddDefaulted_GetRef();
-		NewJob.ProcessHandle = ProcessHandle;
-		NewJob.ReadPipe = PipeRead;
-		NewJob.WritePipe = PipeWrite;
 		NewJob.ExpectedFrameCount = InParams.ExpectedFrameCount;
-		NewJob.LastReportedFrame = 0;
-		NewJob.LastProgressSentTimeSeconds = -1.0;
-		NewJob.EncodeStartTimeSeconds = FPlatformTime::Seconds();
-		NewJob.LastReportedEtaSeconds = -1.0;
-		NewJob.PendingStdOut.Reset();
+		NewJob.Progress.ExpectedFrameCount = InParams.ExpectedFrameCount;
 		NewJob.Shot = InParams.Shot;
+		NewJob.Executable = ExecutableArg;
+		NewJob.CommandLineTemplate = CommandLineArgs;
 
-		// Automatically delete the input files we generated when the job is done
-		bool bDeleteInputTexts = true;
-		UMoviePipelineDebugSettings* DebugSettings = GetPipeline()->GetPipelinePrimaryConfig()->FindSetting<UMoviePipelineDebugSettings>();
-		if (DebugSettings)
+		if (bApplyTimeBudget)
+		{
+			// Without an explicit preset the encoder default is assumed to be the middle of the ladder (medium).
+			NewJob.PresetIndex = InitialPresetIndex != INDEX_NONE ? InitialPresetIndex : EncodeBudgetPresetLadder.Num() / 2;
+			NewJob.BudgetStartTimeSeconds = NewJob.EncodeStartTimeSeconds;
+			NewJob.NextBudgetCheckFrame = EncodeBudgetProbeFrames;
+		}
+
+		if (InParams.AudioIntermediatePath.Len() > 0)
 		{
-			bDeleteInputTexts = !DebugSettings->bWriteAllSamples;
+			NewJob.AudioIntermediatePath = InParams.AudioIntermediatePath;
+			AudioIntermediateRefCounts.FindOrAdd(InParams.AudioIntermediatePath)++;
 		}
 
+		// Automatically delete the input files we generated when the job is done
+		const bool bDeleteInputTexts = ShouldDeleteGeneratedInputs();
+
 		// We delete our auto-generated files (unless you've flagged them to keep with the debug setting)
 		if (bDeleteInputTexts)
 		{
@@ -431,19 +989,334 @@ void UMoviePipelineCustomEncoder::LaunchEncoder(const FEncoderParams& InParams)
 		}
 
 		// And the user's input files (if requested), though we ignore this if you have the Debug Setting asking you to write all samples.
-		if (bDeleteSourceFiles && bDeleteInputTexts)
+		if (ShouldDeleteSourceFiles() && bDeleteInputTexts)
 		{
 			for (const TTuple<FString, TArray<FString>>& Pair : InParams.FilesByExtensionType)
 			{
 				NewJob.FilesToDelete.Append(Pair.Value);
 			}
 		}
+
+		ActiveEncodeJobs.Add(MoveTemp(NewJob));
 	}
 	else
 	{
 		UE_LOG(LogMovieRenderPipeline, Error, TEXT("Failed to launch encoder process, see output log for more details."));
-		GetPipeline()->Shutdown(true);
+		if (UMoviePipeline* Pipeline = GetPipeline())
+		{
+			Pipeline->Shutdown(true);
+		}
+	}
+}
+
+bool UMoviePipelineCustomEncoder::StartEncoderProcess(const FString& InExecutable, const FString& InCommandLineArgs, FActiveJob& OutJob)
+{
+	// Ask ffmpeg for its machine-readable progress stream on stdout. Errors keep going to stderr, which gets its
+	// own pipe so the two never have to be told apart by scraping.
+	const FString CommandLineArgs = FString::Printf(TEXT("-progress pipe:1 -nostats %s"), *InCommandLineArgs);
+
+	const bool bLaunchDetached = false;
+	const bool bLaunchHidden = true;
+	const bool bLaunchReallyHidden = bLaunchHidden;
+
+	void* ProgressPipeRead = nullptr;
+	void* ProgressPipeWrite = nullptr;
+	void* ErrorPipeRead = nullptr;
+	void* ErrorPipeWrite = nullptr;
+
+	verify(FPlatformProcess::CreatePipe(ProgressPipeRead, ProgressPipeWrite));
+	verify(FPlatformProcess::CreatePipe(ErrorPipeRead, ErrorPipeWrite));
+
+	uint32 ProcessId = 0;
+	FProcHandle ProcessHandle = FPlatformProcess::CreateProc(*InExecutable, *CommandLineArgs, bLaunchDetached, bLaunchHidden, bLaunchReallyHidden, &ProcessId, 0, nullptr, ProgressPipeWrite, nullptr, ErrorPipeWrite);
+	if (!ProcessHandle.IsValid())
+	{
+		FPlatformProcess::ClosePipe(ProgressPipeRead, ProgressPipeWrite);
+		FPlatformProcess::ClosePipe(ErrorPipeRead, ErrorPipeWrite);
+		return false;
+	}
+
+	OutJob.ProcessHandle = ProcessHandle;
+	OutJob.ProcessId = ProcessId;
+	OutJob.ProgressReadPipe = ProgressPipeRead;
+	OutJob.ProgressWritePipe = ProgressPipeWrite;
+	OutJob.ErrorReadPipe = ErrorPipeRead;
+	OutJob.ErrorWritePipe = ErrorPipeWrite;
+	OutJob.JobId = FGuid::NewGuid();
+	OutJob.LastReportedFrame = 0;
+	OutJob.LastProgressSentTimeSeconds = -1.0;
+	OutJob.EncodeStartTimeSeconds = FPlatformTime::Seconds();
+	OutJob.LastReportedEtaSeconds = -1.0;
+
+	// Drain the pipes off the game thread so the encoder keeps going even if the engine stops ticking.
+	OutJob.PipeReader = MakeShared<FMoviePipelineEncoderPipeReader>(ProgressPipeRead, ErrorPipeRead);
+	if (!OutJob.PipeReader->Start())
+	{
+		// Without the thread the pipes are read from OnTick, so the encoder can still block while the engine stalls
+		UE_LOG(LogMovieRenderPipeline, Warning, TEXT("Failed to start the encoder pipe reader thread, reading encoder output on the game thread."));
+	}
+
+	return true;
+}
+
+bool UMoviePipelineCustomEncoder::LaunchAudioPreEncode(const FGuid& InJobId, const TArray<FString>& InAudioFiles, const FString& InIntermediatePath, const FStringFormatNamedArguments& InSharedArguments)
+{
+	UMoviePipelineOutputSetting* OutputSetting = GetPipeline()->GetPipelinePrimaryConfig()->FindSetting<UMoviePipelineOutputSetting>();
+	const UMoviePipelineCommandLineEncoderSettings* EncoderSettings = GetDefault<UMoviePipelineCommandLineEncoderSettings>();
+
+	FString ListFilePath;
+	{
+		FMoviePipelineFormatArgs FinalFormatArgs;
+		TMap<FString, FString> FormatOverrides;
+		FormatOverrides.Add(TEXT("ext"), TEXT("txt"));
+		GetPipeline()->ResolveFilenameFormatArguments(OutputSetting->OutputDirectory.Path / InJobId.ToString() + TEXT("_audio_input"), FormatOverrides, ListFilePath, FinalFormatArgs);
+	}
+
+	TStringBuilder<1024> StringBuilder;
+	for (const FString& Path : InAudioFiles)
+	{
+		StringBuilder.Appendf(TEXT("file 'file:%s'%s"), *Path, LINE_TERMINATOR);
+	}
+	FFileHelper::SaveStringToFile(StringBuilder.ToString(), *ListFilePath);
+
+	FStringFormatNamedArguments NamedArgs;
+	NamedArgs.Add(TEXT("InputFile"), ListFilePath);
+	const FString AudioInputArg = FString::Format(*EncoderSettings->AudioInputStringFormat, NamedArgs);
+
+	// Matroska can hold whatever audio codec is configured, the final containers stream-copy from it.
+	const FString CommandLineArgs = FString::Printf(TEXT("-hide_banner -y -loglevel error %s -vn -acodec %s \"%s\""),
+		*AudioInputArg, *InSharedArguments[TEXT("AudioCodec")].StringValue, *InIntermediatePath);
+	UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Audio Pre-Encode Command Line Arguments: %s"), *CommandLineArgs);
+
+	FActiveJob NewJob;
+	if (!StartEncoderProcess(InSharedArguments[TEXT("Executable")].StringValue, CommandLineArgs, NewJob))
+	{
+		UE_LOG(LogMovieRenderPipeline, Warning, TEXT("Failed to launch the audio pre-encode, every render pass will encode the audio itself."));
+		IFileManager::Get().Delete(*ListFilePath);
+		return false;
+	}
+
+	NewJob.JobId = InJobId;
+	NewJob.bIsAudioPreEncode = true;
+	NewJob.AudioIntermediatePath = InIntermediatePath;
+	if (ShouldDeleteGeneratedInputs())
+	{
+		NewJob.FilesToDelete.Add(ListFilePath);
+		if (ShouldDeleteSourceFiles())
+		{
+			NewJob.SourceAudioFiles = InAudioFiles;
+		}
 	}
+
+	ActiveEncodeJobs.Add(MoveTemp(NewJob));
+	return true;
+}
+
+void UMoviePipelineCustomEncoder::OnAudioPreEncodeFinished(const FGuid& InJobId, const FString& InIntermediatePath, const bool bSucceeded)
+{
+	if (!bSucceeded)
+	{
+		UE_LOG(LogMovieRenderPipeline, Warning, TEXT("Audio pre-encode failed, render passes fall back to encoding the audio themselves."));
+	}
+
+	TArray<FPendingEncode> ReadyEncodes;
+	for (int32 Index = PendingEncodeJobs.Num() - 1; Index >= 0; --Index)
+	{
+		if (PendingEncodeJobs[Index].AudioJobId == InJobId)
+		{
+			ReadyEncodes.Insert(MoveTemp(PendingEncodeJobs[Index]), 0);
+			PendingEncodeJobs.RemoveAt(Index);
+		}
+	}
+
+	for (FPendingEncode& ReadyEncode : ReadyEncodes)
+	{
+		if (bSucceeded)
+		{
+			ReadyEncode.Params.FilesByExtensionType.Remove(TEXT("wav"));
+			ReadyEncode.Params.AudioIntermediatePath = InIntermediatePath;
+		}
+
+		LaunchEncoder(ReadyEncode.Params);
+	}
+
+	// Nobody ended up using the intermediate (e.g. all launches failed), so clean it up right away.
+	if (bSucceeded && !AudioIntermediateRefCounts.Contains(InIntermediatePath) && ShouldDeleteGeneratedInputs())
+	{
+		FMoviePipelineIntermediateFileCleanup::DeleteAsync({ InIntermediatePath }, TEXT("Audio"));
+	}
+}
+
+int32 UMoviePipelineCustomEncoder::FindPresetInLadder(const FString& InQualityString) const
+{
+	TArray<FString> Tokens;
+	InQualityString.ParseIntoArrayWS(Tokens);
+
+	// The last -preset wins, same as on the encoder's command line.
+	for (int32 Index = Tokens.Num() - 2; Index >= 0; --Index)
+	{
+		if (Tokens[Index] == TEXT("-preset"))
+		{
+			const FString& Preset = Tokens[Index + 1];
+			return EncodeBudgetPresetLadder.IndexOfByPredicate([&Preset](const FString& LadderPreset) { return LadderPreset.Equals(Preset, ESearchCase::IgnoreCase); });
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+void UMoviePipelineCustomEncoder::UpdateEncodeTimeBudget(FActiveJob& InOutJob)
+{
+	if (InOutJob.NextBudgetCheckFrame <= 0 || InOutJob.Progress.Frame < InOutJob.NextBudgetCheckFrame || InOutJob.Progress.Fps <= SMALL_NUMBER)
+	{
+		return;
+	}
+
+	const double ElapsedSeconds = FPlatformTime::Seconds() - InOutJob.BudgetStartTimeSeconds;
+	const int32 RemainingFrames = FMath::Max(InOutJob.ExpectedFrameCount - InOutJob.Progress.Frame, 0);
+	const double ProjectedSeconds = ElapsedSeconds + RemainingFrames / InOutJob.Progress.Fps;
+	const FString CurrentPreset = InOutJob.Progress.Preset.Len() > 0 ? InOutJob.Progress.Preset : FString(TEXT("Quality setting"));
+
+	if (ProjectedSeconds <= EncodeTimeBudgetSeconds)
+	{
+		UE_LOG(LogMovieRenderPipeline, Log, TEXT("Command Line Encoder: %s at %.1f fps (%.2fx) fits the time budget, projected %.0fs of %.0fs."),
+			*CurrentPreset, InOutJob.Progress.Fps, InOutJob.Progress.Speed, ProjectedSeconds, EncodeTimeBudgetSeconds);
+		InOutJob.NextBudgetCheckFrame = 0;
+		return;
+	}
+
+	if (InOutJob.PresetIndex >= EncodeBudgetPresetLadder.Num() - 1)
+	{
+		UE_LOG(LogMovieRenderPipeline, Warning, TEXT("Command Line Encoder: projected %.0fs exceeds the time budget of %.0fs, but %s is already the fastest preset."),
+			ProjectedSeconds, EncodeTimeBudgetSeconds, *CurrentPreset);
+		InOutJob.NextBudgetCheckFrame = 0;
+		return;
+	}
+
+	// A restart begins again at the first frame, so the new preset has to fit the whole encode into what's left.
+	const double RemainingBudgetSeconds = EncodeTimeBudgetSeconds - ElapsedSeconds;
+	const double FullEncodeSeconds = InOutJob.ExpectedFrameCount / InOutJob.Progress.Fps;
+	const double RequiredSpeedup = RemainingBudgetSeconds > SMALL_NUMBER ? FullEncodeSeconds / RemainingBudgetSeconds : TNumericLimits<float>::Max();
+	const int32 Steps = FMath::Max(1, FMath::CeilToInt(FMath::Loge(FMath::Max(RequiredSpeedup, 1.0)) / FMath::Loge(EncodePresetStepSpeedup)));
+	const int32 NewPresetIndex = FMath::Min(InOutJob.PresetIndex + Steps, EncodeBudgetPresetLadder.Num() - 1);
+	const FString NewPreset = EncodeBudgetPresetLadder[NewPresetIndex];
+
+	UE_LOG(LogMovieRenderPipeline, Log, TEXT("Command Line Encoder: %s at %.1f fps (%.2fx) projects %.0fs, over the time budget of %.0fs. Restarting with preset %s."),
+		*CurrentPreset, InOutJob.Progress.Fps, InOutJob.Progress.Speed, ProjectedSeconds, EncodeTimeBudgetSeconds, *NewPreset);
+
+	const bool bKillTree = true;
+	FPlatformProcess::TerminateProc(InOutJob.ProcessHandle, bKillTree);
+	FPlatformProcess::WaitForProc(InOutJob.ProcessHandle);
+	if (InOutJob.PipeReader.IsValid())
+	{
+		InOutJob.PipeReader->StopAndWait();
+		InOutJob.PipeReader.Reset();
+	}
+	FPlatformProcess::ClosePipe(InOutJob.ProgressReadPipe, InOutJob.ProgressWritePipe);
+	FPlatformProcess::ClosePipe(InOutJob.ErrorReadPipe, InOutJob.ErrorWritePipe);
+	FPlatformProcess::CloseProc(InOutJob.ProcessHandle);
+	InOutJob.ProgressReadPipe = InOutJob.ProgressWritePipe = nullptr;
+	InOutJob.ErrorReadPipe = InOutJob.ErrorWritePipe = nullptr;
+
+	InOutJob.PresetIndex = NewPresetIndex;
+	InOutJob.NextBudgetCheckFrame = EncodeBudgetProbeFrames;
+	InOutJob.Progress = FMoviePipelineEncoderProgress();
+	InOutJob.Progress.ExpectedFrameCount = InOutJob.ExpectedFrameCount;
+	InOutJob.Progress.Preset = NewPreset;
+
+	const FString CommandLineArgs = InOutJob.CommandLineTemplate.Replace(EncodePresetToken, *FString::Printf(TEXT(" -preset %s"), *NewPreset));
+	if (!StartEncoderProcess(InOutJob.Executable, CommandLineArgs, InOutJob))
+	{
+		UE_LOG(LogMovieRenderPipeline, Error, TEXT("Failed to restart encoder process with preset %s, see output log for more details."), *NewPreset);
+		InOutJob.NextBudgetCheckFrame = 0;
+		if (UMoviePipeline* Pipeline = GetPipeline())
+		{
+			Pipeline->Shutdown(true);
+		}
+	}
+}
+
+FString UMoviePipelineCustomEncoder::GetChunkEncodeArgs(const double InFrameRate, const FString& InExtension) const
+{
+	if (!bEncodeAsChunk)
+	{
+		return FString();
+	}
+
+	// Fixed-size closed GOPs starting on the first frame of the chunk, so every fragment can be joined with a stream copy.
+	// Scene cut detection would insert keyframes at different places in every chunk.
+	const int32 GopSize = ChunkGopSize > 0 ? ChunkGopSize : FMath::Max(1, FMath::RoundToInt(InFrameRate));
+	FString Args = FString::Printf(TEXT(" -g %d -keyint_min %d -sc_threshold 0 -flags +cgop -force_key_frames expr:eq(n,0)"), GopSize, GopSize);
+
+	// The same timescale in every fragment keeps the concat demuxer from rescaling timestamps. Only the mov family
+	// muxer knows the option, others reject it.
+	const FString Extension = InExtension.ToLower();
+	if (Extension == TEXT("mp4") || Extension == TEXT("mov") || Extension == TEXT("m4v"))
+	{
+		Args += TEXT(" -video_track_timescale 90000");
+	}
+
+	return Args;
+}
+
+void UMoviePipelineCustomEncoder::MoveChunkAudio(FEncoderParams& InOutParams)
+{
+	TArray<FString> AudioFiles;
+	if (!InOutParams.FilesByExtensionType.RemoveAndCopyValue(TEXT("wav"), AudioFiles))
+	{
+		return;
+	}
+
+	// The stitch encodes the audio of all chunks in one go. Encoding it per chunk would leave an encoder delay gap at every join.
+	// The stitcher concatenates the wavs in name order, so the counter runs on over every shot and pass of the chunk.
+	const FString ChunkDirectory = FPaths::GetPath(InOutParams.OutputPaths[0]);
+	int32& AudioCount = ChunkAudioCountByDirectory.FindOrAdd(ChunkDirectory);
+	for (int32 Index = 0; Index < AudioFiles.Num(); ++Index)
+	{
+		bool bAlreadyMoved = false;
+		MovedChunkAudioFiles.Add(AudioFiles[Index], &bAlreadyMoved);
+		if (bAlreadyMoved)
+		{
+			continue;
+		}
+
+		const FString Destination = ChunkDirectory / FString::Printf(TEXT("audio_%03d.wav"), AudioCount++);
+		if (!IFileManager::Get().Move(*Destination, *AudioFiles[Index]))
+		{
+			UE_LOG(LogMovieRenderPipelineIO, Warning, TEXT("Failed to move chunk audio '%s' to '%s', the stitched output will miss it."), *AudioFiles[Index], *Destination);
+		}
+	}
+}
+
+void UMoviePipelineCustomEncoder::WriteChunkFragmentLists() const
+{
+	// Rewritten in full on every flush, per-shot encodes add their fragments to the same chunk directory
+	TMap<FString, TArray<FString>> FragmentNamesByDirectory;
+	for (const FString& OutputPath : PipelineOutputPaths)
+	{
+		FragmentNamesByDirectory.FindOrAdd(FPaths::GetPath(OutputPath)).AddUnique(FPaths::GetCleanFilename(OutputPath));
+	}
+
+	for (const TTuple<FString, TArray<FString>>& Pair : FragmentNamesByDirectory)
+	{
+		const FString ListPath = Pair.Key / FMoviePipelineChunkStitcher::FragmentListFileName;
+		if (!FFileHelper::SaveStringArrayToFile(Pair.Value, *ListPath))
+		{
+			UE_LOG(LogMovieRenderPipelineIO, Warning, TEXT("Failed to write the fragment list '%s', the stitch will pick fragments by extension."), *ListPath);
+		}
+	}
+}
+
+bool UMoviePipelineCustomEncoder::ShouldDeleteSourceFiles() const
+{
+	return bDeleteSourceFiles && !bRetainSourceFrames;
+}
+
+bool UMoviePipelineCustomEncoder::ShouldDeleteGeneratedInputs() const
+{
+	UMoviePipeline* Pipeline = GetPipeline();
+	UMoviePipelineDebugSettings* DebugSettings = Pipeline ? Pipeline->GetPipelinePrimaryConfig()->FindSetting<UMoviePipelineDebugSettings>() : nullptr;
+	return DebugSettings ? !DebugSettings->bWriteAllSamples : true;
 }
 
 void UMoviePipelineCustomEncoder::OnTick()
@@ -454,39 +1327,28 @@ void UMoviePipelineCustomEncoder::OnTick()
 	{
 		FActiveJob& Job = ActiveEncodeJobs[Index];
 
-		auto ProcessLine = [&](const FString& InLine)
+		auto ProcessProgressRecord = [&](const FMoviePipelineEncoderProgress& InRecord)
 		{
-			FString TrimmedLine = InLine;
-			TrimmedLine.TrimStartAndEndInline();
+			Job.Progress.Frame = InRecord.Frame;
+			Job.Progress.Fps = InRecord.Fps;
+			Job.Progress.Speed = InRecord.Speed;
+			Job.Progress.OutTimeUs = InRecord.OutTimeUs;
+			Job.Progress.bEnded = InRecord.bEnded;
 
-			if (TrimmedLine.IsEmpty())
+			if (Job.Progress.Frame <= Job.LastReportedFrame)
 			{
 				return;
 			}
 
-			UE_LOG(LogMovieRenderPipeline, Error, TEXT("%s: Trimmed ffmpeg output log: %s"), ANSI_TO_TCHAR(__FUNCTION__), *TrimmedLine);
-
-			int32 ParsedFrameValue = 0;
-			if (!TryExtractFrameCount(TrimmedLine, ParsedFrameValue))
-			{
-				return;
-			}
-
-			if (ParsedFrameValue <= Job.LastReportedFrame)
-			{
-				return;
-			}
-
-			Job.LastReportedFrame = ParsedFrameValue;
+			Job.LastReportedFrame = Job.Progress.Frame;
 
 			if (Job.ExpectedFrameCount <= 0)
 			{
 				return;
 			}
 
-			const float Progress = FMath::Clamp(static_cast<float>(Job.LastReportedFrame) / static_cast<float>(Job.ExpectedFrameCount), 0.0f, 1.0f);
+			const float Progress = Job.Progress.GetCompletion();
 			const double NowSeconds = FPlatformTime::Seconds();
-			
 
 			if (Job.EncodeStartTimeSeconds < 0.0)
 			{
@@ -495,14 +1357,21 @@ void UMoviePipelineCustomEncoder::OnTick()
 			
 			constexpr double MinUpdateIntervalSeconds = 0.1;
 
-			const double ElapsedSeconds = Job.EncodeStartTimeSeconds >= 0.0 ? FMath::Max(NowSeconds - Job.EncodeStartTimeSeconds, 0.0) : -1.0;
+			// Prefer the throughput ffmpeg measured itself, fall back to extrapolating the elapsed time.
 			double EstimatedRemainingSeconds = -1.0;
-			if (ElapsedSeconds > SMALL_NUMBER && Progress > KINDA_SMALL_NUMBER)
+			if (Job.Progress.Fps > SMALL_NUMBER)
 			{
-				const double EstimatedTotalSeconds = ElapsedSeconds / FMath::Clamp(static_cast<double>(Progress), KINDA_SMALL_NUMBER, 1.0);
-				EstimatedRemainingSeconds = FMath::Max(EstimatedTotalSeconds - ElapsedSeconds, 0.0);
+				EstimatedRemainingSeconds = FMath::Max(Job.ExpectedFrameCount - Job.Progress.Frame, 0) / Job.Progress.Fps;
+			}
+			else
+			{
+				const double ElapsedSeconds = FMath::Max(NowSeconds - Job.EncodeStartTimeSeconds, 0.0);
+				if (ElapsedSeconds > SMALL_NUMBER && Progress > KINDA_SMALL_NUMBER)
+				{
+					const double EstimatedTotalSeconds = ElapsedSeconds / FMath::Clamp(static_cast<double>(Progress), KINDA_SMALL_NUMBER, 1.0);
+					EstimatedRemainingSeconds = FMath::Max(EstimatedTotalSeconds - ElapsedSeconds, 0.0);
+				}
 			}
-			
 
 			const bool bShouldForceUpdate = Progress >= 1.f;
 			if (bShouldForceUpdate || Job.LastProgressSentTimeSeconds < 0.0 || (NowSeconds - Job.LastProgressSentTimeSeconds) >= MinUpdateIntervalSeconds)
@@ -510,7 +1379,7 @@ void UMoviePipelineCustomEncoder::OnTick()
 				Job.LastProgressSentTimeSeconds = NowSeconds;
 				if (UMoviePipelineExecutorShot* Shot = Job.Shot.Get())
 				{
-					UE_LOG(LogTemp, Log, TEXT("%s: Shot status progress: %d"), ANSI_TO_TCHAR(__FUNCTION__), static_cast<int>(Progress * 100.0f));
+					UE_LOG(LogTemp, Verbose, TEXT("%s: Shot status progress: %d (%.1f fps, %.2fx)"), ANSI_TO_TCHAR(__FUNCTION__), static_cast<int>(Progress * 100.0f), Job.Progress.Fps, Job.Progress.Speed);
 					Shot->SetStatusProgress(Progress);
 
 					if (EstimatedRemainingSeconds >= 0.0)
@@ -527,44 +1396,43 @@ void UMoviePipelineCustomEncoder::OnTick()
 						}
 					}
 				}
-				
 			}
 		};
 
-		auto ConsumOutput = [&](const FString& InOutput, const bool bFlushTail)
+		// Only the newest record matters for reporting, older ones queued up since the last tick are skipped.
+		auto ConsumeReaderOutput = [&]()
 		{
-			if (!InOutput.IsEmpty())
+			FMoviePipelineEncoderProgress Record;
+			bool bHasRecord = false;
+			while (Job.PipeReader->DequeueProgress(Record))
 			{
-				FString NormalizedOutput = InOutput;
-				NormalizedOutput.ReplaceInline(TEXT("\r\n"), TEXT("\n"), ESearchCase::CaseSensitive);
-				NormalizedOutput.ReplaceInline(TEXT("\r"), TEXT("\n"), ESearchCase::CaseSensitive);
-				Job.PendingStdOut += NormalizedOutput;
+				bHasRecord = true;
 			}
-
-			int32 NewlineIndex;
-			while (Job.PendingStdOut.FindChar(TEXT('\n'), NewlineIndex))
+			if (bHasRecord)
 			{
-				FString Line = Job.PendingStdOut.Left(NewlineIndex);
-				Job.PendingStdOut.RemoveAt(0, NewlineIndex + 1, false);
-				ProcessLine(Line);
+				ProcessProgressRecord(Record);
 			}
 
-			if (bFlushTail && !Job.PendingStdOut.IsEmpty())
+			// Progress has its own pipe and the default global arguments suppress everything but errors,
+			// so whatever arrives on stderr is a real diagnostic.
+			FString ErrorLine;
+			while (Job.PipeReader->DequeueErrorLine(ErrorLine))
 			{
-				FString Remainder = Job.PendingStdOut;
-				Job.PendingStdOut.Reset();
-				ProcessLine(Remainder);
+				UE_LOG(LogMovieRenderPipeline, Error, TEXT("Command Line Encoder: %s"), *ErrorLine);
 			}
 		};
-		
-		TArray<uint8> ProcessOutput;
-		FString Results = FPlatformProcess::ReadPipe(Job.ReadPipe);
-		if (Results.Len() > 0)
+
+		if (Job.PipeReader.IsValid())
+		{
+			Job.PipeReader->Pump();
+			ConsumeReaderOutput();
+		}
+
+		SampleEncoderProcessUsage(Job.ProcessId, Job.Progress);
+
+		if (!Job.bIsAudioPreEncode && FPlatformProcess::IsProcRunning(Job.ProcessHandle))
 		{
-			ConsumOutput(Results, false);
-			// The default global arguments suppress everything but errors. We unfortunately can't tell stdout from stderr
-			// using a non-blocking platform process launch, so we'll just promote all the output as an error log.
-			UE_LOG(LogMovieRenderPipeline, Error, TEXT("Command Line Encoder: %s"), *Results);
+			UpdateEncodeTimeBudget(Job);
 		}
 
 		// If they hit escape during  a render, (potentially) cancel the encode job
@@ -583,7 +1451,14 @@ void UMoviePipelineCustomEncoder::OnTick()
 		const bool bProcessFinished = !FPlatformProcess::IsProcRunning(Job.ProcessHandle);
 		if (bProcessFinished || bCancelEncode)
 		{
-			ConsumOutput(TEXT(""), true);
+			// The reader performs a last drain of whatever the process wrote before exiting.
+			if (Job.PipeReader.IsValid())
+			{
+				Job.PipeReader->StopAndWait();
+				ConsumeReaderOutput();
+				Job.PipeReader.Reset();
+			}
+
 			if (Job.ExpectedFrameCount > 0 && !bCancelEncode)
 			{
 				const float Progress = 1.f;
@@ -593,24 +1468,139 @@ void UMoviePipelineCustomEncoder::OnTick()
 					Shot->SetStatusMessage(TEXT(""));
 				}
 			}
+
+			int32 ReturnCode = -1;
+			const bool bSucceeded = !bCancelEncode && FPlatformProcess::GetProcReturnCode(Job.ProcessHandle, &ReturnCode) && ReturnCode == 0;
+			if (!bSucceeded && !bCancelEncode)
+			{
+				bEncodeFailed = true;
+			}
+
+			if (Job.bIsAudioPreEncode)
+			{
+				UE_LOG(LogMovieRenderPipeline, Log, TEXT("Command Line Encoder finished audio pre-encode '%s'%s"),
+					*Job.AudioIntermediatePath, bCancelEncode ? TEXT(" (canceled)") : TEXT(""));
+			}
+			else
+			{
+				UE_LOG(LogMovieRenderPipeline, Log, TEXT("Command Line Encoder finished: %d frames, %.1f fps, %.2fx speed%s%s"),
+					Job.Progress.Frame, Job.Progress.Fps, Job.Progress.Speed,
+					Job.Progress.Preset.Len() > 0 ? *FString::Printf(TEXT(", preset %s"), *Job.Progress.Preset) : TEXT(""),
+					bCancelEncode ? TEXT(" (canceled)") : TEXT(""));
+
+				LastEncoderProgress = Job.Progress;
+				bHasEncoderProgress = true;
+			}
 			
-			FPlatformProcess::ClosePipe(Job.ReadPipe, Job.WritePipe);
+			FPlatformProcess::ClosePipe(Job.ProgressReadPipe, Job.ProgressWritePipe);
+			FPlatformProcess::ClosePipe(Job.ErrorReadPipe, Job.ErrorWritePipe);
 			FPlatformProcess::CloseProc(Job.ProcessHandle);
 
-			IFileManager& FileManager = IFileManager::Get();
-			for (const FString& FilePath : Job.FilesToDelete)
+			// The source audio is only safe to drop once the intermediate actually exists.
+			if (Job.bIsAudioPreEncode && bSucceeded)
 			{
-				const bool bRequireExist = false;
-				const bool bEvenReadOnly = false;
-				const bool bQuiet = false;
-				FileManager.Delete(*FilePath, bRequireExist, bEvenReadOnly, bQuiet);
+				Job.FilesToDelete.Append(Job.SourceAudioFiles);
 			}
 
+			// The shared intermediate goes away with the last render pass that muxed it.
+			if (!Job.bIsAudioPreEncode && Job.AudioIntermediatePath.Len() > 0)
+			{
+				int32* RefCount = AudioIntermediateRefCounts.Find(Job.AudioIntermediatePath);
+				if (RefCount && --(*RefCount) <= 0)
+				{
+					AudioIntermediateRefCounts.Remove(Job.AudioIntermediatePath);
+					if (ShouldDeleteGeneratedInputs())
+					{
+						Job.FilesToDelete.Add(Job.AudioIntermediatePath);
+					}
+				}
+			}
+
+			// Deleting thousands of frames can take seconds on a network share, so hand it to a background task.
+			// Executors wait for it (bounded) before the process exits.
+			if (Job.FilesToDelete.Num() > 0)
+			{
+				const FString CleanupLabel = Job.Shot.IsValid() ? Job.Shot->OuterName : FString(TEXT("Encode"));
+				FMoviePipelineIntermediateFileCleanup::DeleteAsync(MoveTemp(Job.FilesToDelete), CleanupLabel);
+			}
+
+			// Launching the waiting render passes appends to ActiveEncodeJobs, so take what we need first.
+			const bool bWasAudioPreEncode = Job.bIsAudioPreEncode;
+			const FGuid FinishedJobId = Job.JobId;
+			const FString IntermediatePath = Job.AudioIntermediatePath;
 			ActiveEncodeJobs.RemoveAt(Index);
+
+			if (bWasAudioPreEncode)
+			{
+				if (bCancelEncode)
+				{
+					PendingEncodeJobs.RemoveAll([&FinishedJobId](const FPendingEncode& Pending) { return Pending.AudioJobId == FinishedJobId; });
+				}
+				else
+				{
+					OnAudioPreEncodeFinished(FinishedJobId, IntermediatePath, bSucceeded);
+				}
+			}
 		}
 	}
 }
 
+bool UMoviePipelineCustomEncoder::GetEncoderProgress(FMoviePipelineEncoderProgress& OutProgress) const
+{
+	if (ActiveEncodeJobs.Num() == 0)
+	{
+		OutProgress = LastEncoderProgress;
+		return bHasEncoderProgress;
+	}
+
+	// Render passes encode side by side: frames and throughput add up, while the slowest job bounds speed and time.
+	FMoviePipelineEncoderProgress Combined;
+	Combined.Speed = TNumericLimits<double>::Max();
+	Combined.OutTimeUs = TNumericLimits<int64>::Max();
+	int32 NumVideoJobs = 0;
+	for (const FActiveJob& Job : ActiveEncodeJobs)
+	{
+		if (Job.bIsAudioPreEncode)
+		{
+			continue;
+		}
+
+		++NumVideoJobs;
+		Combined.Frame += Job.Progress.Frame;
+		Combined.ExpectedFrameCount += Job.Progress.ExpectedFrameCount;
+		Combined.Fps += Job.Progress.Fps;
+		Combined.Speed = FMath::Min(Combined.Speed, Job.Progress.Speed);
+		Combined.OutTimeUs = FMath::Min(Combined.OutTimeUs, Job.Progress.OutTimeUs);
+
+		// The processes run side by side, so their memory and reads add up
+		auto AddUsage = [](int64& InOutTotal, const int64 InValue)
+		{
+			if (InValue >= 0)
+			{
+				InOutTotal = FMath::Max<int64>(InOutTotal, 0) + InValue;
+			}
+		};
+		AddUsage(Combined.PeakResidentBytes, Job.Progress.PeakResidentBytes);
+		AddUsage(Combined.ReadBytes, Job.Progress.ReadBytes);
+		AddUsage(Combined.StorageReadBytes, Job.Progress.StorageReadBytes);
+
+		if (Job.Progress.Preset.Len() > 0 && !Combined.Preset.Contains(Job.Progress.Preset))
+		{
+			Combined.Preset += Combined.Preset.Len() > 0 ? TEXT(",") + Job.Progress.Preset : Job.Progress.Preset;
+		}
+	}
+
+	// Only the shared audio is being encoded so far.
+	if (NumVideoJobs == 0)
+	{
+		OutProgress = LastEncoderProgress;
+		return bHasEncoderProgress;
+	}
+
+	OutProgress = Combined;
+	return true;
+}
+
 bool UMoviePipelineCustomEncoder::NeedsPerShotFlushing() const
 {
 	UMoviePipelineOutputSetting* OutputSetting = GetPipeline()->GetPipelinePrimaryConfig()->FindSetting<UMoviePipelineOutputSetting>();
@@ -627,6 +1617,11 @@ bool UMoviePipelineCustomEncoder::NeedsPerShotFlushing() const
 
 void UMoviePipelineCustomEncoder::SetupForPipelineImpl(UMoviePipeline* InPipeline)
 {
+	PipelineOutputPaths.Reset();
+	MovedChunkAudioFiles.Reset();
+	ChunkAudioCountByDirectory.Reset();
+	bEncodeFailed = false;
+
 	if (InPipeline && NeedsPerShotFlushing())
 	{
 		InPipeline->SetFlushDiskWritesPerShot(true);
@@ -637,9 +1632,14 @@ void UMoviePipelineCustomEncoder::SetupForPipelineImpl(UMoviePipeline* InPipelin
 }
 
 FString UMoviePipelineCustomEncoder::GetQualitySettingString() const
+{
+	return GetQualitySettingString(Quality);
+}
+
+FString UMoviePipelineCustomEncoder::GetQualitySettingString(const EMoviePipelineEncodeQuality InQuality)
 {
 	const UMoviePipelineCommandLineEncoderSettings* EncoderSettings = GetDefault<UMoviePipelineCommandLineEncoderSettings>();
-	switch (Quality)
+	switch (InQuality)
 	{
 	case EMoviePipelineEncodeQuality::Low:
 		return EncoderSettings->EncodeSettings_Low;
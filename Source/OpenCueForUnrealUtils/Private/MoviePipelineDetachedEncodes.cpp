@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "MoviePipelineDetachedEncodes.h"
+#include "MoviePipelineCustomEncoder.h"
+#include "MovieRenderPipelineCoreModule.h"
+#include "Containers/Ticker.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace
+{
+	struct FDetachedEncode
+	{
+		TStrongObjectPtr<UMoviePipelineCustomEncoder> Encoder;
+		FString JobId;
+		TArray<FString> OutputPaths;
+		double StartTime = 0.0;
+	};
+
+	bool GEnabled = false;
+	TArray<FDetachedEncode> GEncodes;
+	FTSTicker::FDelegateHandle GTickerHandle;
+	FMoviePipelineDetachedEncodes::FOnDetachedEncodeFinished GOnFinished;
+
+	/** Returns true while any adopted encode is still running. */
+	bool TickEncodes()
+	{
+		for (int32 Index = GEncodes.Num() - 1; Index >= 0; --Index)
+		{
+			if (GEncodes[Index].Encoder->TickStandaloneEncode())
+			{
+				continue;
+			}
+
+			FDetachedEncode Finished = MoveTemp(GEncodes[Index]);
+			GEncodes.RemoveAt(Index);
+
+			// The exit codes are not kept past OnTick, an output that exists and isn't empty is what matters
+			bool bSuccess = !Finished.Encoder->HasEncodeFailed();
+			for (const FString& OutputPath : Finished.OutputPaths)
+			{
+				bSuccess &= IFileManager::Get().FileSize(*OutputPath) > 0;
+			}
+
+			UE_LOG(LogMovieRenderPipeline, Log, TEXT("Detached encode of %s %s after %.1fs"),
+				*Finished.JobId, bSuccess ? TEXT("finished") : TEXT("failed"), FPlatformTime::Seconds() - Finished.StartTime);
+			GOnFinished.Broadcast(Finished.JobId, bSuccess, Finished.OutputPaths);
+		}
+
+		return GEncodes.Num() > 0;
+	}
+
+	bool OnTicker(float InDeltaTime)
+	{
+		const bool bRunning = TickEncodes();
+		if (!bRunning)
+		{
+			GTickerHandle.Reset();
+		}
+		return bRunning;
+	}
+}
+
+void FMoviePipelineDetachedEncodes::SetEnabled(bool bInEnabled)
+{
+	GEnabled = bInEnabled;
+}
+
+bool FMoviePipelineDetachedEncodes::IsEnabled()
+{
+	return GEnabled;
+}
+
+void FMoviePipelineDetachedEncodes::Adopt(UMoviePipelineCustomEncoder* InEncoder, const FString& InJobId, const TArray<FString>& InOutputPaths)
+{
+	check(IsInGameThread());
+	if (!InEncoder)
+	{
+		return;
+	}
+
+	FDetachedEncode& Encode = GEncodes.AddDefaulted_GetRef();
+	Encode.Encoder.Reset(InEncoder);
+	Encode.JobId = InJobId;
+	Encode.OutputPaths = InOutputPaths;
+	Encode.StartTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogMovieRenderPipeline, Log, TEXT("Detached encode of %s into %d output(s), %d detached encode(s) running"),
+		*InJobId, InOutputPaths.Num(), GEncodes.Num());
+
+	if (!GTickerHandle.IsValid())
+	{
+		GTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&OnTicker), 0.1f);
+	}
+}
+
+bool FMoviePipelineDetachedEncodes::WaitForAll(double InTimeoutSeconds)
+{
+	check(IsInGameThread());
+
+	const double StartTime = FPlatformTime::Seconds();
+	while (GEncodes.Num() > 0)
+	{
+		if (FPlatformTime::Seconds() - StartTime >= InTimeoutSeconds)
+		{
+			UE_LOG(LogMovieRenderPipeline, Warning, TEXT("%d detached encode(s) still running after %.1fs"), GEncodes.Num(), InTimeoutSeconds);
+			return false;
+		}
+
+		if (TickEncodes())
+		{
+			FPlatformProcess::Sleep(0.01f);
+		}
+	}
+
+	if (GTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(GTickerHandle);
+		GTickerHandle.Reset();
+	}
+	return true;
+}
+
+int32 FMoviePipelineDetachedEncodes::GetNumActive()
+{
+	return GEncodes.Num();
+}
+
+bool FMoviePipelineDetachedEncodes::IsEncoding(const FString& InJobId)
+{
+	return GEncodes.ContainsByPredicate([&InJobId](const FDetachedEncode& Encode) { return Encode.JobId == InJobId; });
+}
+
+FMoviePipelineDetachedEncodes::FOnDetachedEncodeFinished& FMoviePipelineDetachedEncodes::OnFinished()
+{
+	return GOnFinished;
+}
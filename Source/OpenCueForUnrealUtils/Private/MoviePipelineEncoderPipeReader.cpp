@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "MoviePipelineEncoderPipeReader.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformProcess.h"
+#include "MovieRenderPipelineCoreModule.h"
+
+namespace
+{
+	/** How long the reader sleeps when both pipes were empty. Short enough that ffmpeg never fills a pipe. */
+	constexpr float IdleSleepSeconds = 0.01f;
+}
+
+FMoviePipelineEncoderPipeReader::FMoviePipelineEncoderPipeReader(void* InProgressReadPipe, void* InErrorReadPipe)
+	: ProgressReadPipe(InProgressReadPipe)
+	, ErrorReadPipe(InErrorReadPipe)
+	, bStopRequested(false)
+{
+}
+
+FMoviePipelineEncoderPipeReader::~FMoviePipelineEncoderPipeReader()
+{
+	StopAndWait();
+}
+
+bool FMoviePipelineEncoderPipeReader::Start()
+{
+	check(!Thread);
+	Thread = FRunnableThread::Create(this, TEXT("MoviePipelineEncoderPipeReader"), 0, TPri_BelowNormal);
+	return Thread != nullptr;
+}
+
+void FMoviePipelineEncoderPipeReader::StopAndWait()
+{
+	if (!Thread)
+	{
+		// Pumped by the owner, which only stops us once the process exited
+		if (!bPumpFinished)
+		{
+			bPumpFinished = true;
+			DrainPipes();
+			FlushPending();
+		}
+		return;
+	}
+
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+}
+
+void FMoviePipelineEncoderPipeReader::Pump()
+{
+	if (!Thread && !bPumpFinished)
+	{
+		DrainPipes();
+	}
+}
+
+uint32 FMoviePipelineEncoderPipeReader::Run()
+{
+	while (!bStopRequested)
+	{
+		if (!DrainPipes())
+		{
+			FPlatformProcess::SleepNoStats(IdleSleepSeconds);
+		}
+	}
+
+	// The owner only stops us once the process exited, so this picks up its last words.
+	DrainPipes();
+	FlushPending();
+	return 0;
+}
+
+bool FMoviePipelineEncoderPipeReader::DrainPipes()
+{
+	auto ProcessProgressLine = [this](const FStringView InLine)
+	{
+		UE_LOG(LogMovieRenderPipeline, VeryVerbose, TEXT("Command Line Encoder progress: %.*s"), InLine.Len(), InLine.GetData());
+		if (ProgressParser.ParseLine(InLine))
+		{
+			ProgressRecords.Enqueue(ProgressParser.GetCurrent());
+		}
+	};
+
+	auto ProcessErrorLine = [this](const FStringView InLine)
+	{
+		ErrorLines.Enqueue(FString(InLine));
+	};
+
+	const FString ProgressChunk = FPlatformProcess::ReadPipe(ProgressReadPipe);
+	const FString ErrorChunk = FPlatformProcess::ReadPipe(ErrorReadPipe);
+
+	ProgressLines.Consume(ProgressChunk, ProcessProgressLine);
+	PendingErrorLines.Consume(ErrorChunk, ProcessErrorLine);
+
+	return !ProgressChunk.IsEmpty() || !ErrorChunk.IsEmpty();
+}
+
+void FMoviePipelineEncoderPipeReader::FlushPending()
+{
+	ProgressLines.Flush([this](const FStringView InLine)
+	{
+		if (ProgressParser.ParseLine(InLine))
+		{
+			ProgressRecords.Enqueue(ProgressParser.GetCurrent());
+		}
+	});
+
+	PendingErrorLines.Flush([this](const FStringView InLine)
+	{
+		ErrorLines.Enqueue(FString(InLine));
+	});
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Containers/Queue.h"
+#include "MoviePipelineEncoderProgress.h"
+#include <atomic>
+
+class FRunnableThread;
+
+/**
+ * Drains the stdout (-progress) and stderr pipes of one encoder process on a background thread so the
+ * encoder never blocks on a full pipe when the engine stops ticking. Parsed progress records and error
+ * lines are handed to the game thread through single-producer/single-consumer lock-free queues.
+ *
+ * The reader only touches the read ends of the pipes. The owner keeps the process handle, decides when
+ * the process has exited and then calls StopAndWait() which performs one last drain before returning.
+ * If the thread cannot be created the owner calls Pump() every tick instead and reads on its own thread.
+ */
+class FMoviePipelineEncoderPipeReader : public FRunnable
+{
+public:
+	FMoviePipelineEncoderPipeReader(void* InProgressReadPipe, void* InErrorReadPipe);
+	virtual ~FMoviePipelineEncoderPipeReader();
+
+	/** Spawn the reader thread. Returns false if the thread could not be created. */
+	bool Start();
+
+	/** Ask the thread to finish, wait for its final drain and join it. Safe to call more than once. */
+	void StopAndWait();
+
+	/** Read the pipes on the calling thread if Start() failed, no-op otherwise. Game thread only. */
+	void Pump();
+
+	/** Pop the next parsed progress record. Game thread only. */
+	bool DequeueProgress(FMoviePipelineEncoderProgress& OutProgress) { return ProgressRecords.Dequeue(OutProgress); }
+
+	/** Pop the next line the encoder wrote to stderr. Game thread only. */
+	bool DequeueErrorLine(FString& OutLine) { return ErrorLines.Dequeue(OutLine); }
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override { bStopRequested = true; }
+	//~ End FRunnable Interface
+
+private:
+	/** Read everything currently buffered in both pipes. Returns true if anything was read. */
+	bool DrainPipes();
+	void FlushPending();
+
+	void* ProgressReadPipe;
+	void* ErrorReadPipe;
+
+	FRunnableThread* Thread = nullptr;
+	std::atomic<bool> bStopRequested;
+	// Set once the final drain ran on the owner's thread, when there is no reader thread
+	bool bPumpFinished = false;
+
+	// Only touched by the reader thread
+	FMoviePipelineEncoderLineBuffer ProgressLines;
+	FMoviePipelineEncoderLineBuffer PendingErrorLines;
+	FMoviePipelineEncoderProgressParser ProgressParser;
+
+	TQueue<FMoviePipelineEncoderProgress, EQueueMode::Spsc> ProgressRecords;
+	TQueue<FString, EQueueMode::Spsc> ErrorLines;
+};
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "MoviePipelineEncoderProgress.h"
+
+namespace
+{
+	bool IsNotAvailable(const FStringView Value)
+	{
+		return Value.IsEmpty() || Value.Equals(TEXTVIEW("N/A"), ESearchCase::IgnoreCase);
+	}
+}
+
+bool FMoviePipelineEncoderProgressParser::ParseLine(FStringView Line)
+{
+	int32 SeparatorIndex = INDEX_NONE;
+	if (!Line.FindChar(TEXT('='), SeparatorIndex))
+	{
+		return false;
+	}
+
+	const FStringView Key = Line.Left(SeparatorIndex).TrimStartAndEnd();
+	FStringView Value = Line.Mid(SeparatorIndex + 1).TrimStartAndEnd();
+
+	if (Key.Equals(TEXTVIEW("progress")))
+	{
+		Current.bEnded = Value.Equals(TEXTVIEW("end"));
+		return true;
+	}
+
+	if (IsNotAvailable(Value))
+	{
+		return false;
+	}
+
+	// The values are short ASCII numbers, so a small copy keeps the conversion null terminated.
+	if (Key.Equals(TEXTVIEW("frame")))
+	{
+		Current.Frame = FCString::Atoi(*FString(Value));
+	}
+	else if (Key.Equals(TEXTVIEW("fps")))
+	{
+		Current.Fps = FCString::Atod(*FString(Value));
+	}
+	else if (Key.Equals(TEXTVIEW("speed")))
+	{
+		// Reported as e.g. "1.25x"
+		if (Value.EndsWith(TEXT('x')))
+		{
+			Value.LeftChopInline(1);
+		}
+		Current.Speed = FCString::Atod(*FString(Value));
+	}
+	else if (Key.Equals(TEXTVIEW("out_time_us")))
+	{
+		Current.OutTimeUs = FCString::Atoi64(*FString(Value));
+	}
+
+	return false;
+}
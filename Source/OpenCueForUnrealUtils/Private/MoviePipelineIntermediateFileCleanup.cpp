@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "MoviePipelineIntermediateFileCleanup.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Paths.h"
+#include "MovieRenderPipelineCoreModule.h"
+#include <atomic>
+
+namespace
+{
+	std::atomic<int32> GNumPendingBatches(0);
+
+	void RunCleanup(const TArray<FString>& InFiles, const FString& InLabel)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		IFileManager& FileManager = IFileManager::Get();
+
+		TMap<FString, TSet<FString>> FilesByDirectory;
+		for (const FString& File : InFiles)
+		{
+			FString NormalizedFile = File;
+			FPaths::NormalizeFilename(NormalizedFile);
+			FilesByDirectory.FindOrAdd(FPaths::GetPath(NormalizedFile)).Add(NormalizedFile);
+		}
+
+		int32 NumDeleted = 0;
+		int32 NumFailed = 0;
+		int32 NumDirectoriesRemoved = 0;
+		for (const TPair<FString, TSet<FString>>& Pair : FilesByDirectory)
+		{
+			bool bDeletedAll = true;
+			for (const FString& File : Pair.Value)
+			{
+				const bool bRequireExist = false;
+				const bool bEvenReadOnly = false;
+				const bool bQuiet = true;
+				if (FileManager.Delete(*File, bRequireExist, bEvenReadOnly, bQuiet))
+				{
+					++NumDeleted;
+				}
+				else
+				{
+					++NumFailed;
+					bDeletedAll = false;
+				}
+			}
+
+			// Not a tree delete: it only succeeds if nothing else was written into the directory in the meantime
+			if (bDeletedAll && !Pair.Key.IsEmpty())
+			{
+				const bool bRequireExists = false;
+				const bool bTree = false;
+				if (FileManager.DeleteDirectory(*Pair.Key, bRequireExists, bTree))
+				{
+					++NumDirectoriesRemoved;
+				}
+			}
+		}
+
+		UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Intermediate cleanup '%s': deleted %d files, removed %d empty directories, %d failed, %.2fs."),
+			*InLabel, NumDeleted, NumDirectoriesRemoved, NumFailed, FPlatformTime::Seconds() - StartTime);
+
+		AsyncTask(ENamedThreads::GameThread, [InLabel, NumDeleted, NumFailed]()
+		{
+			FMoviePipelineIntermediateFileCleanup::OnCleanupFinished().Broadcast(InLabel, NumDeleted, NumFailed);
+		});
+	}
+}
+
+void FMoviePipelineIntermediateFileCleanup::DeleteAsync(TArray<FString>&& InFiles, const FString& InLabel)
+{
+	if (InFiles.Num() == 0)
+	{
+		return;
+	}
+
+	++GNumPendingBatches;
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [Files = MoveTemp(InFiles), Label = InLabel]()
+	{
+		RunCleanup(Files, Label);
+		--GNumPendingBatches;
+	}, LowLevelTasks::ETaskPriority::BackgroundNormal);
+}
+
+bool FMoviePipelineIntermediateFileCleanup::WaitForPendingDeletes(double InTimeoutSeconds)
+{
+	const double Deadline = FPlatformTime::Seconds() + FMath::Max(InTimeoutSeconds, 0.0);
+	while (GNumPendingBatches.load() > 0)
+	{
+		if (FPlatformTime::Seconds() >= Deadline)
+		{
+			UE_LOG(LogMovieRenderPipelineIO, Warning, TEXT("Timed out after %.1fs waiting for %d intermediate cleanup batches."), InTimeoutSeconds, GNumPendingBatches.load());
+			return false;
+		}
+		FPlatformProcess::Sleep(0.01f);
+	}
+
+	return true;
+}
+
+int32 FMoviePipelineIntermediateFileCleanup::GetNumPendingBatches()
+{
+	return GNumPendingBatches.load();
+}
+
+FMoviePipelineIntermediateFileCleanup::FOnCleanupFinished& FMoviePipelineIntermediateFileCleanup::OnCleanupFinished()
+{
+	static FOnCleanupFinished Delegate;
+	return Delegate;
+}
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "MoviePipelineRetainedFrames.h"
+#include "MoviePipelineCustomEncoder.h"
+#include "MoviePipelineIntermediateFileCleanup.h"
+#include "MovieRenderPipelineCoreModule.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Tasks/Task.h"
+#include <atomic>
+
+const TCHAR* FMoviePipelineRetainedFrames::ManifestSuffix = TEXT(".opencue-frames.json");
+
+namespace
+{
+	std::atomic<bool> GSweepInProgress(false);
+
+	TArray<TSharedPtr<FJsonValue>> MakeRelativePaths(const TArray<FString>& InFiles, const FString& InManifestDirectory)
+	{
+		TArray<TSharedPtr<FJsonValue>> Values;
+		for (FString File : InFiles)
+		{
+			FPaths::MakePathRelativeTo(File, *(InManifestDirectory / TEXT("")));
+			Values.Add(MakeShared<FJsonValueString>(File));
+		}
+		return Values;
+	}
+
+	void ReadRelativePaths(const TSharedPtr<FJsonObject>& InObject, const TCHAR* InField, const FString& InManifestDirectory, TArray<FString>& OutFiles)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+		if (!InObject->TryGetArrayField(InField, Values))
+		{
+			return;
+		}
+
+		for (const TSharedPtr<FJsonValue>& Value : *Values)
+		{
+			FString File = FPaths::ConvertRelativePathToFull(InManifestDirectory, Value->AsString());
+			FPaths::NormalizeFilename(File);
+			OutFiles.Add(MoveTemp(File));
+		}
+	}
+}
+
+FString FMoviePipelineRetainedFrames::WriteManifest(const FMoviePipelineStandaloneEncodeRequest& InRequest, double InRetentionHours)
+{
+	if (InRequest.VideoFiles.Num() == 0)
+	{
+		return FString();
+	}
+
+	const FString ManifestDirectory = FPaths::GetPath(InRequest.VideoFiles[0]);
+	const FString ManifestPath = ManifestDirectory / FPaths::GetBaseFilename(InRequest.OutputPathNoExtension) + ManifestSuffix;
+	const FDateTime NowUtc = FDateTime::UtcNow();
+
+	TSharedPtr<FJsonObject> RootObj = MakeShared<FJsonObject>();
+	RootObj->SetNumberField(TEXT("manifest_version"), 1);
+	RootObj->SetNumberField(TEXT("frame_rate"), InRequest.FrameRate);
+	RootObj->SetStringField(TEXT("output_path"), InRequest.OutputPathNoExtension);
+	RootObj->SetStringField(TEXT("created_utc"), NowUtc.ToIso8601());
+	RootObj->SetStringField(TEXT("expires_utc"), (NowUtc + FTimespan::FromHours(InRetentionHours)).ToIso8601());
+	RootObj->SetArrayField(TEXT("video_files"), MakeRelativePaths(InRequest.VideoFiles, ManifestDirectory));
+	RootObj->SetArrayField(TEXT("audio_files"), MakeRelativePaths(InRequest.AudioFiles, ManifestDirectory));
+
+	FString ManifestJson;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ManifestJson);
+	if (!FJsonSerializer::Serialize(RootObj.ToSharedRef(), Writer) || !FFileHelper::SaveStringToFile(ManifestJson, *ManifestPath))
+	{
+		UE_LOG(LogMovieRenderPipelineIO, Warning, TEXT("Failed to write retained frames manifest '%s'."), *ManifestPath);
+		return FString();
+	}
+
+	UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Retaining %d frames until %s, manifest '%s'."),
+		InRequest.VideoFiles.Num(), *(NowUtc + FTimespan::FromHours(InRetentionHours)).ToIso8601(), *ManifestPath);
+	return ManifestPath;
+}
+
+bool FMoviePipelineRetainedFrames::ReadManifest(const FString& InManifestPath, FMoviePipelineStandaloneEncodeRequest& OutRequest, FDateTime& OutExpiresUtc)
+{
+	FString ManifestJson;
+	if (!FFileHelper::LoadFileToString(ManifestJson, *InManifestPath))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> RootObj;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ManifestJson);
+	if (!FJsonSerializer::Deserialize(Reader, RootObj) || !RootObj.IsValid())
+	{
+		UE_LOG(LogMovieRenderPipelineIO, Warning, TEXT("Retained frames manifest '%s' is not valid JSON."), *InManifestPath);
+		return false;
+	}
+
+	const FString ManifestDirectory = FPaths::GetPath(InManifestPath);
+	OutRequest = FMoviePipelineStandaloneEncodeRequest();
+	RootObj->TryGetNumberField(TEXT("frame_rate"), OutRequest.FrameRate);
+	RootObj->TryGetStringField(TEXT("output_path"), OutRequest.OutputPathNoExtension);
+	ReadRelativePaths(RootObj, TEXT("video_files"), ManifestDirectory, OutRequest.VideoFiles);
+	ReadRelativePaths(RootObj, TEXT("audio_files"), ManifestDirectory, OutRequest.AudioFiles);
+
+	FString ExpiresString;
+	OutExpiresUtc = FDateTime::MaxValue();
+	if (RootObj->TryGetStringField(TEXT("expires_utc"), ExpiresString))
+	{
+		FDateTime::ParseIso8601(*ExpiresString, OutExpiresUtc);
+	}
+
+	return OutRequest.VideoFiles.Num() > 0;
+}
+
+int32 FMoviePipelineRetainedFrames::DeleteExpired(const FString& InRootDirectory)
+{
+	TArray<FString> ManifestPaths;
+	IFileManager::Get().FindFilesRecursive(ManifestPaths, *InRootDirectory, *(FString(TEXT("*")) + ManifestSuffix), true, false);
+
+	const FDateTime NowUtc = FDateTime::UtcNow();
+	int32 NumExpired = 0;
+	for (const FString& ManifestPath : ManifestPaths)
+	{
+		FMoviePipelineStandaloneEncodeRequest Request;
+		FDateTime ExpiresUtc;
+		if (!ReadManifest(ManifestPath, Request, ExpiresUtc) || ExpiresUtc > NowUtc)
+		{
+			continue;
+		}
+
+		TArray<FString> FilesToDelete = MoveTemp(Request.VideoFiles);
+		FilesToDelete.Append(Request.AudioFiles);
+		FilesToDelete.Add(ManifestPath);
+
+		UE_LOG(LogMovieRenderPipelineIO, Log, TEXT("Retained frames of '%s' expired at %s, deleting %d files."), *ManifestPath, *ExpiresUtc.ToIso8601(), FilesToDelete.Num());
+		FMoviePipelineIntermediateFileCleanup::DeleteAsync(MoveTemp(FilesToDelete), FPaths::GetCleanFilename(ManifestPath));
+		++NumExpired;
+	}
+
+	return NumExpired;
+}
+
+void FMoviePipelineRetainedFrames::DeleteExpiredAsync(const FString& InRootDirectory)
+{
+	bool bExpected = false;
+	if (!GSweepInProgress.compare_exchange_strong(bExpected, true))
+	{
+		return;
+	}
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [RootDirectory = InRootDirectory]()
+	{
+		DeleteExpired(RootDirectory);
+		GSweepInProgress = false;
+	}, LowLevelTasks::ETaskPriority::BackgroundLow);
+}
+
+FString FMoviePipelineRetainedFrames::GetDefaultSweepDirectory()
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("MovieRenders"));
+}
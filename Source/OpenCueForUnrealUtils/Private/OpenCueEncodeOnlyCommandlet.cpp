@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "OpenCueEncodeOnlyCommandlet.h"
+#include "MoviePipelineCustomEncoder.h"
+#include "MoviePipelineCommandLineEncoderSettings.h"
+#include "MoviePipelineIntermediateFileCleanup.h"
+#include "MoviePipelineRetainedFrames.h"
+#include "MovieRenderPipelineCoreModule.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(OpenCueEncodeOnlyCommandlet)
+
+namespace
+{
+	/** Frames in a plain directory, in name order. Audio is picked up from the same directory. */
+	bool CollectFramesFromDirectory(const FString& InDirectory, FMoviePipelineStandaloneEncodeRequest& OutRequest)
+	{
+		TArray<FString> FileNames;
+		IFileManager::Get().FindFiles(FileNames, *(InDirectory / TEXT("*")), true, false);
+		FileNames.Sort();
+
+		for (const FString& FileName : FileNames)
+		{
+			const FString Extension = FPaths::GetExtension(FileName).ToLower();
+			if (Extension == TEXT("wav"))
+			{
+				OutRequest.AudioFiles.Add(InDirectory / FileName);
+			}
+			else if (Extension == TEXT("png") || Extension == TEXT("jpeg") || Extension == TEXT("jpg") || Extension == TEXT("exr") || Extension == TEXT("bmp"))
+			{
+				OutRequest.VideoFiles.Add(InDirectory / FileName);
+			}
+		}
+
+		OutRequest.OutputPathNoExtension = FPaths::GetPath(InDirectory) / FPaths::GetCleanFilename(InDirectory);
+		return OutRequest.VideoFiles.Num() > 0;
+	}
+}
+
+UOpenCueEncodeOnlyCommandlet::UOpenCueEncodeOnlyCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UOpenCueEncodeOnlyCommandlet::Main(const FString& Params)
+{
+	FString ManifestPath;
+	FString FramesDir;
+	FString OutputPath;
+	FString QualityName;
+	FString ExtraArgs;
+	FString VideoCodec;
+	FString AudioCodec;
+	FString Extension;
+	FString Executable;
+	FString SweepDir;
+	double FrameRate = 0.0;
+
+	FParse::Value(*Params, TEXT("-Manifest="), ManifestPath);
+	FParse::Value(*Params, TEXT("-FramesDir="), FramesDir);
+	FParse::Value(*Params, TEXT("-FrameRate="), FrameRate);
+	FParse::Value(*Params, TEXT("-Output="), OutputPath);
+	FParse::Value(*Params, TEXT("-Quality="), QualityName);
+	FParse::Value(*Params, TEXT("-ExtraArgs="), ExtraArgs);
+	FParse::Value(*Params, TEXT("-VideoCodec="), VideoCodec);
+	FParse::Value(*Params, TEXT("-AudioCodec="), AudioCodec);
+	FParse::Value(*Params, TEXT("-Extension="), Extension);
+	FParse::Value(*Params, TEXT("-Executable="), Executable);
+	if (!FParse::Value(*Params, TEXT("-SweepExpired="), SweepDir) && FParse::Param(*Params, TEXT("SweepExpired")))
+	{
+		SweepDir = FMoviePipelineRetainedFrames::GetDefaultSweepDirectory();
+	}
+
+	if (SweepDir.Len() > 0)
+	{
+		const int32 NumExpired = FMoviePipelineRetainedFrames::DeleteExpired(SweepDir);
+		UE_LOG(LogMovieRenderPipeline, Display, TEXT("[EncodeOnly] %d expired retained frame sets below '%s'."), NumExpired, *SweepDir);
+	}
+
+	FMoviePipelineStandaloneEncodeRequest Request;
+	if (ManifestPath.Len() > 0)
+	{
+		FDateTime ExpiresUtc;
+		if (!FMoviePipelineRetainedFrames::ReadManifest(ManifestPath, Request, ExpiresUtc))
+		{
+			UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncodeOnly] Failed to read manifest '%s'."), *ManifestPath);
+			FMoviePipelineIntermediateFileCleanup::WaitForPendingDeletes(30.0);
+			return 1;
+		}
+		if (ExpiresUtc < FDateTime::UtcNow())
+		{
+			UE_LOG(LogMovieRenderPipeline, Warning, TEXT("[EncodeOnly] Retained frames expired at %s, encoding what is still there."), *ExpiresUtc.ToIso8601());
+		}
+	}
+	else if (FramesDir.Len() > 0)
+	{
+		if (!CollectFramesFromDirectory(FramesDir, Request))
+		{
+			UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncodeOnly] No frames found in '%s'."), *FramesDir);
+			FMoviePipelineIntermediateFileCleanup::WaitForPendingDeletes(30.0);
+			return 1;
+		}
+	}
+	else if (SweepDir.Len() > 0)
+	{
+		// Only asked to clean up.
+		return FMoviePipelineIntermediateFileCleanup::WaitForPendingDeletes(60.0) ? 0 : 1;
+	}
+	else
+	{
+		UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncodeOnly] Either -Manifest= or -FramesDir= is required."));
+		return 1;
+	}
+
+	if (FrameRate > 0.0)
+	{
+		Request.FrameRate = FrameRate;
+	}
+	if (OutputPath.Len() > 0)
+	{
+		Request.OutputPathNoExtension = OutputPath;
+	}
+	else if (ManifestPath.Len() > 0)
+	{
+		// The manifest records the original encode's output, which must not be overwritten by a re-encode by default.
+		Request.OutputPathNoExtension += TEXT("_reencode");
+	}
+
+	for (const FString& FramePath : Request.VideoFiles)
+	{
+		if (!IFileManager::Get().FileExists(*FramePath))
+		{
+			UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncodeOnly] Retained frame '%s' is missing."), *FramePath);
+			FMoviePipelineIntermediateFileCleanup::WaitForPendingDeletes(30.0);
+			return 1;
+		}
+	}
+
+	// Overrides only live in this process, the Project Settings on disk are left alone.
+	UMoviePipelineCommandLineEncoderSettings* EncoderSettings = GetMutableDefault<UMoviePipelineCommandLineEncoderSettings>();
+	if (Executable.Len() > 0)
+	{
+		EncoderSettings->ExecutablePath = Executable;
+	}
+	if (VideoCodec.Len() > 0)
+	{
+		EncoderSettings->VideoCodec = VideoCodec;
+	}
+	if (AudioCodec.Len() > 0)
+	{
+		EncoderSettings->AudioCodec = AudioCodec;
+	}
+	if (Extension.Len() > 0)
+	{
+		EncoderSettings->OutputFileExtension = Extension;
+	}
+
+	UMoviePipelineCustomEncoder* Encoder = NewObject<UMoviePipelineCustomEncoder>(GetTransientPackage());
+	Encoder->bDeleteSourceFiles = false;
+	Encoder->AdditionalCommandLineArgs = ExtraArgs;
+	if (QualityName.Len() > 0)
+	{
+		const int64 Value = StaticEnum<EMoviePipelineEncodeQuality>()->GetValueByNameString(QualityName);
+		if (Value == INDEX_NONE)
+		{
+			UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncodeOnly] Unknown quality '%s', expected Low, Medium, High or Epic."), *QualityName);
+			return 1;
+		}
+		Encoder->Quality = static_cast<EMoviePipelineEncodeQuality>(Value);
+	}
+
+	UE_LOG(LogMovieRenderPipeline, Display, TEXT("[EncodeOnly] Encoding %d frames at %.3f fps to '%s'."), Request.VideoFiles.Num(), Request.FrameRate, *Request.OutputPathNoExtension);
+
+	const double StartTime = FPlatformTime::Seconds();
+	TArray<FString> OutputPaths;
+	const bool bSucceeded = Encoder->EncodeStandaloneBlocking(Request, OutputPaths);
+
+	FMoviePipelineEncoderProgress Progress;
+	Encoder->GetEncoderProgress(Progress);
+	UE_LOG(LogMovieRenderPipeline, Display, TEXT("[EncodeOnly] %s in %.1fs (%.1f fps, %.2fx): %s"),
+		bSucceeded ? TEXT("Finished") : TEXT("FAILED"), FPlatformTime::Seconds() - StartTime, Progress.Fps, Progress.Speed, *FString::Join(OutputPaths, TEXT(", ")));
+
+	FMoviePipelineIntermediateFileCleanup::WaitForPendingDeletes(30.0);
+	return bSucceeded ? 0 : 1;
+}
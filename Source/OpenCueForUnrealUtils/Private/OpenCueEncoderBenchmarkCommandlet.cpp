@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "OpenCueEncoderBenchmarkCommandlet.h"
+#include "MoviePipelineCustomEncoder.h"
+#include "MoviePipelineCommandLineEncoderSettings.h"
+#include "MoviePipelineIntermediateFileCleanup.h"
+#include "MovieRenderPipelineCoreModule.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Modules/ModuleManager.h"
+#include "HAL/FileManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(OpenCueEncoderBenchmarkCommandlet)
+
+namespace
+{
+	bool GetImageFormat(const FString& InFormat, EImageFormat& OutFormat, FString& OutExtension)
+	{
+		if (InFormat.Equals(TEXT("png"), ESearchCase::IgnoreCase))
+		{
+			OutFormat = EImageFormat::PNG;
+			OutExtension = TEXT("png");
+			return true;
+		}
+		if (InFormat.Equals(TEXT("jpg"), ESearchCase::IgnoreCase) || InFormat.Equals(TEXT("jpeg"), ESearchCase::IgnoreCase))
+		{
+			OutFormat = EImageFormat::JPEG;
+			OutExtension = TEXT("jpeg");
+			return true;
+		}
+		if (InFormat.Equals(TEXT("bmp"), ESearchCase::IgnoreCase))
+		{
+			OutFormat = EImageFormat::BMP;
+			OutExtension = TEXT("bmp");
+			return true;
+		}
+		return false;
+	}
+
+	/** A gradient that moves every frame plus some grain, so the encoder sees motion and detail instead of a flat image. */
+	void FillSyntheticFrame(TArray<FColor>& OutPixels, const int32 InWidth, const int32 InHeight, const int32 InFrameIndex)
+	{
+		FRandomStream Random(InFrameIndex);
+		const int32 Offset = InFrameIndex * 4;
+
+		OutPixels.SetNumUninitialized(InWidth * InHeight);
+		for (int32 Y = 0; Y < InHeight; ++Y)
+		{
+			for (int32 X = 0; X < InWidth; ++X)
+			{
+				const int32 Grain = Random.RandRange(0, 15);
+				OutPixels[Y * InWidth + X] = FColor(
+					static_cast<uint8>(((X + Offset) * 255 / InWidth + Grain) & 0xFF),
+					static_cast<uint8>(((Y + Offset) * 255 / InHeight + Grain) & 0xFF),
+					static_cast<uint8>(((X + Y) / 4 + Offset + Grain) & 0xFF),
+					255);
+			}
+		}
+	}
+}
+
+bool UOpenCueEncoderBenchmarkCommandlet::WriteSyntheticFrames(const FString& InDirectory, const int32 InWidth, const int32 InHeight, const int32 InNumFrames, const FString& InFormat,
+	TArray<FString>& OutFramePaths, int64& OutTotalBytes)
+{
+	EImageFormat ImageFormat = EImageFormat::Invalid;
+	FString Extension;
+	if (!GetImageFormat(InFormat, ImageFormat, Extension))
+	{
+		UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncoderBenchmark] Unsupported format '%s', expected png, jpg or bmp."), *InFormat);
+		return false;
+	}
+
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
+	IFileManager::Get().MakeDirectory(*InDirectory, true);
+
+	OutTotalBytes = 0;
+	TArray<FColor> Pixels;
+	for (int32 FrameIndex = 0; FrameIndex < InNumFrames; ++FrameIndex)
+	{
+		const FString FramePath = InDirectory / FString::Printf(TEXT("Benchmark.%04d.%s"), FrameIndex, *Extension);
+		FillSyntheticFrame(Pixels, InWidth, InHeight, FrameIndex);
+
+		if (!ImageWrapper.IsValid() || !ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(FColor), InWidth, InHeight, ERGBFormat::BGRA, 8))
+		{
+			UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncoderBenchmark] Failed to compress synthetic frame %d."), FrameIndex);
+			return false;
+		}
+
+		const TArray64<uint8> Compressed = ImageWrapper->GetCompressed();
+		if (!FFileHelper::SaveArrayToFile(Compressed, *FramePath))
+		{
+			UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncoderBenchmark] Failed to write '%s'."), *FramePath);
+			return false;
+		}
+
+		FPaths::NormalizeFilename(OutFramePaths.Add_GetRef(FramePath));
+		OutTotalBytes += Compressed.Num();
+	}
+
+	return true;
+}
+
+UOpenCueEncoderBenchmarkCommandlet::UOpenCueEncoderBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UOpenCueEncoderBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 Width = 1920;
+	int32 Height = 1080;
+	int32 NumFrames = 240;
+	double FrameRate = 24.0;
+	int32 Iterations = 1;
+	FString Format = TEXT("png");
+	FString QualityList = TEXT("Epic");
+	FString ExtraArgs;
+	FString Executable;
+	FString OutputDir = FPaths::ProjectSavedDir() / TEXT("EncoderBenchmark");
+	FString ReportPath;
+
+	FParse::Value(*Params, TEXT("-Width="), Width);
+	FParse::Value(*Params, TEXT("-Height="), Height);
+	FParse::Value(*Params, TEXT("-Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("-FrameRate="), FrameRate);
+	FParse::Value(*Params, TEXT("-Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("-Format="), Format);
+	FParse::Value(*Params, TEXT("-Quality="), QualityList);
+	FParse::Value(*Params, TEXT("-ExtraArgs="), ExtraArgs);
+	FParse::Value(*Params, TEXT("-Executable="), Executable);
+	FParse::Value(*Params, TEXT("-OutputDir="), OutputDir);
+	FParse::Value(*Params, TEXT("-Report="), ReportPath);
+	const bool bUseImageSequencePattern = !FParse::Param(*Params, TEXT("NoPattern"));
+	const bool bKeepFiles = FParse::Param(*Params, TEXT("KeepFiles"));
+
+	EImageFormat ImageFormat = EImageFormat::Invalid;
+	FString Extension;
+	if (!GetImageFormat(Format, ImageFormat, Extension))
+	{
+		UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncoderBenchmark] Unsupported -Format=%s, expected png, jpg or bmp."), *Format);
+		return 1;
+	}
+
+	if (Width <= 0 || Height <= 0 || NumFrames <= 0 || FrameRate <= 0.0 || Iterations <= 0)
+	{
+		UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncoderBenchmark] Width, Height, Frames, FrameRate and Iterations need to be positive."));
+		return 1;
+	}
+
+	TArray<EMoviePipelineEncodeQuality> Qualities;
+	{
+		TArray<FString> QualityNames;
+		QualityList.ParseIntoArray(QualityNames, TEXT(","));
+		for (const FString& QualityName : QualityNames)
+		{
+			const int64 Value = StaticEnum<EMoviePipelineEncodeQuality>()->GetValueByNameString(QualityName.TrimStartAndEnd());
+			if (Value == INDEX_NONE)
+			{
+				UE_LOG(LogMovieRenderPipeline, Error, TEXT("[EncoderBenchmark] Unknown quality '%s', expected Low, Medium, High or Epic."), *QualityName);
+				return 1;
+			}
+			Qualities.Add(static_cast<EMoviePipelineEncodeQuality>(Value));
+		}
+	}
+
+	if (Executable.Len() > 0)
+	{
+		GetMutableDefault<UMoviePipelineCommandLineEncoderSettings>()->ExecutablePath = Executable;
+	}
+
+	// Numbered like MRQ output, so the image sequence pattern applies unless -NoPattern is given.
+	const FString FramesDir = OutputDir / FString::Printf(TEXT("Frames_%dx%d_%s"), Width, Height, *Extension);
+	TArray<FString> FramePaths;
+	int64 InputBytes = 0;
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		if (!WriteSyntheticFrames(FramesDir, Width, Height, NumFrames, Format, FramePaths, InputBytes))
+		{
+			return 1;
+		}
+
+		UE_LOG(LogMovieRenderPipeline, Display, TEXT("[EncoderBenchmark] Generated %d %dx%d %s frames (%.1f MB) in %.1fs."),
+			NumFrames, Width, Height, *Extension, InputBytes / (1024.0 * 1024.0), FPlatformTime::Seconds() - StartTime);
+	}
+
+	UMoviePipelineCustomEncoder* Encoder = NewObject<UMoviePipelineCustomEncoder>(GetTransientPackage());
+	Encoder->bDeleteSourceFiles = false;
+	Encoder->bUseImageSequencePattern = bUseImageSequencePattern;
+	Encoder->AdditionalCommandLineArgs = ExtraArgs;
+
+	TStringBuilder<1024> Report;
+	int32 NumFailed = 0;
+	for (const EMoviePipelineEncodeQuality Quality : Qualities)
+	{
+		const FString QualityName = StaticEnum<EMoviePipelineEncodeQuality>()->GetNameStringByValue(static_cast<int64>(Quality));
+		Encoder->Quality = Quality;
+
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			FMoviePipelineStandaloneEncodeRequest Request;
+			Request.VideoFiles = FramePaths;
+			Request.FrameRate = FrameRate;
+			Request.OutputPathNoExtension = OutputDir / FString::Printf(TEXT("Benchmark_%s_%d"), *QualityName, Iteration);
+			Request.WorkingDirectory = OutputDir;
+
+			const double StartTime = FPlatformTime::Seconds();
+
+			TArray<FString> OutputPaths;
+			bool bSucceeded = Encoder->EncodeStandaloneBlocking(Request, OutputPaths);
+
+			const double WallSeconds = FPlatformTime::Seconds() - StartTime;
+
+			FMoviePipelineEncoderProgress Progress;
+			Encoder->GetEncoderProgress(Progress);
+
+			int64 OutputBytes = 0;
+			for (const FString& OutputPath : OutputPaths)
+			{
+				OutputBytes += FMath::Max<int64>(IFileManager::Get().FileSize(*OutputPath), 0);
+				if (!bKeepFiles)
+				{
+					IFileManager::Get().Delete(*OutputPath);
+				}
+			}
+
+			const double Throughput = WallSeconds > 0.0 ? NumFrames / WallSeconds : 0.0;
+
+			// Sampled from the encoder process itself, -1 where /proc isn't available
+			UE_LOG(LogMovieRenderPipeline, Display, TEXT("[EncoderBenchmark] %s #%d: %s in %.2fs, %.1f frames/s (encoder %.1f fps, %.2fx), output %.1f MB, peak encoder RSS %.1f MB, read %.1f MB (%.1f MB from storage)"),
+				*QualityName, Iteration, bSucceeded ? TEXT("ok") : TEXT("FAILED"), WallSeconds, Throughput, Progress.Fps, Progress.Speed,
+				OutputBytes / (1024.0 * 1024.0), Progress.PeakResidentBytes / (1024.0 * 1024.0), Progress.ReadBytes / (1024.0 * 1024.0),
+				Progress.StorageReadBytes / (1024.0 * 1024.0));
+
+			Report.Appendf(TEXT("%s,%d,%d,%d,%d,%s,%d,%d,%.3f,%.2f,%.2f,%.3f,%lld,%lld,%lld,%lld,%lld%s"),
+				*QualityName, Iteration, Width, Height, NumFrames, *Extension, bUseImageSequencePattern ? 1 : 0, bSucceeded ? 1 : 0,
+				WallSeconds, Throughput, Progress.Fps, Progress.Speed, InputBytes, OutputBytes,
+				Progress.PeakResidentBytes, Progress.ReadBytes, Progress.StorageReadBytes, LINE_TERMINATOR);
+
+			if (!bSucceeded)
+			{
+				++NumFailed;
+			}
+		}
+	}
+
+	if (ReportPath.Len() > 0)
+	{
+		// Append so CI can collect several configurations (resolutions, formats) into one file.
+		FString ReportText;
+		if (!IFileManager::Get().FileExists(*ReportPath))
+		{
+			ReportText = FString(TEXT("quality,iteration,width,height,frames,format,pattern,succeeded,wall_seconds,throughput_fps,encoder_fps,encoder_speed,input_bytes,output_bytes,peak_encoder_rss_bytes,encoder_read_bytes,encoder_storage_read_bytes")) + LINE_TERMINATOR;
+		}
+		ReportText += Report.ToString();
+		FFileHelper::SaveStringToFile(ReportText, *ReportPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
+	}
+
+	// The generated input lists are deleted on a background task.
+	FMoviePipelineIntermediateFileCleanup::WaitForPendingDeletes(30.0);
+	if (!bKeepFiles)
+	{
+		IFileManager::Get().DeleteDirectory(*FramesDir, false, true);
+	}
+
+	return NumFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "OpenCueRetryBackoff.h"
+#include "HAL/PlatformProcess.h"
+
+FOpenCueRetryBackoff::FOpenCueRetryBackoff(double InBaseDelaySec, double InMaxDelaySec, int32 InTripAfterFailures, double InOpenDurationSec)
+	: BaseDelaySec(FMath::Max(InBaseDelaySec, 0.0))
+	, MaxDelaySec(FMath::Max(InMaxDelaySec, InBaseDelaySec))
+	, TripAfterFailures(InTripAfterFailures)
+	// An open period shorter than the capped backoff delay would make the circuit retry sooner than plain backoff
+	, OpenDurationSec(FMath::Max(InOpenDurationSec, MaxDelaySec))
+	, CurrentOpenDurationSec(OpenDurationSec)
+	// Workers started together must not share a sequence, or their jitter would be identical
+	, RandomStream(static_cast<int32>(FPlatformTime::Cycles() ^ (FPlatformProcess::GetCurrentProcessId() * 2654435761u)))
+{
+}
+
+bool FOpenCueRetryBackoff::CanAttempt(double InNow) const
+{
+	return InNow >= NextAttemptTime;
+}
+
+void FOpenCueRetryBackoff::OnSuccess()
+{
+	if (bCircuitOpen)
+	{
+		UE_LOG(LogTemp, Log, TEXT("[OpenCue] Circuit closed after %d consecutive failure(s)"), ConsecutiveFailures);
+	}
+
+	ConsecutiveFailures = 0;
+	NextAttemptTime = 0.0;
+	bCircuitOpen = false;
+	CurrentOpenDurationSec = OpenDurationSec;
+}
+
+void FOpenCueRetryBackoff::OnFailure(double InNow)
+{
+	++ConsecutiveFailures;
+	++TotalFailures;
+
+	if (TripAfterFailures > 0 && ConsecutiveFailures >= TripAfterFailures)
+	{
+		if (!bCircuitOpen)
+		{
+			++TotalTrips;
+			UE_LOG(LogTemp, Warning, TEXT("[OpenCue] Circuit opened after %d consecutive failures, pausing for ~%.0fs"), ConsecutiveFailures, CurrentOpenDurationSec);
+		}
+		else
+		{
+			// A half-open probe failed: the outage is a long one, so probe less often
+			CurrentOpenDurationSec = FMath::Min(CurrentOpenDurationSec * 2.0, OpenDurationSec * 4.0);
+		}
+
+		// Wait out the open period before the next probe
+		bCircuitOpen = true;
+		NextAttemptTime = InNow + CurrentOpenDurationSec * RandomStream.FRandRange(0.75f, 1.25f);
+		return;
+	}
+
+	const double Exponent = static_cast<double>(FMath::Min(ConsecutiveFailures - 1, 30));
+	const double Delay = FMath::Min(MaxDelaySec, BaseDelaySec * FMath::Pow(2.0, Exponent));
+	NextAttemptTime = InNow + Delay * 0.5 + Delay * 0.5 * RandomStream.GetFraction();
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "OpenCueStitchCommandlet.h"
+#include "MoviePipelineChunkStitcher.h"
+#include "MoviePipelineCommandLineEncoderSettings.h"
+#include "MovieRenderPipelineCoreModule.h"
+#include "HAL/FileManager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(OpenCueStitchCommandlet)
+
+UOpenCueStitchCommandlet::UOpenCueStitchCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UOpenCueStitchCommandlet::Main(const FString& Params)
+{
+	FString JobDir;
+	FString OutputDir;
+	FString Executable;
+	FParse::Value(*Params, TEXT("-JobDir="), JobDir);
+	FParse::Value(*Params, TEXT("-Output="), OutputDir);
+	FParse::Value(*Params, TEXT("-Executable="), Executable);
+	const bool bAllowGaps = FParse::Param(*Params, TEXT("AllowGaps"));
+	const bool bDeleteChunks = FParse::Param(*Params, TEXT("DeleteChunks"));
+
+	if (JobDir.IsEmpty())
+	{
+		UE_LOG(LogMovieRenderPipeline, Error, TEXT("[Stitch] -JobDir= is required."));
+		return 1;
+	}
+	if (OutputDir.IsEmpty())
+	{
+		OutputDir = JobDir;
+	}
+	if (Executable.Len() > 0)
+	{
+		GetMutableDefault<UMoviePipelineCommandLineEncoderSettings>()->ExecutablePath = Executable;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	TArray<FString> OutputPaths;
+	const bool bSucceeded = FMoviePipelineChunkStitcher::Stitch(JobDir, OutputDir, bAllowGaps, OutputPaths);
+	UE_LOG(LogMovieRenderPipeline, Display, TEXT("[Stitch] %s in %.1fs: %s"),
+		bSucceeded ? TEXT("Finished") : TEXT("FAILED"), FPlatformTime::Seconds() - StartTime, *FString::Join(OutputPaths, TEXT(", ")));
+
+	// Only throw the fragments away once the deliverable is there, a failed stitch can be retried.
+	if (bSucceeded && bDeleteChunks)
+	{
+		for (const FMoviePipelineChunkStitcher::FChunk& Chunk : FMoviePipelineChunkStitcher::FindChunks(JobDir))
+		{
+			IFileManager::Get().DeleteDirectory(*Chunk.Directory, false, true);
+		}
+	}
+
+	return bSucceeded ? 0 : 1;
+}
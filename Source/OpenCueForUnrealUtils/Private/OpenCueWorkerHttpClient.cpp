@@ -0,0 +1,234 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "OpenCueWorkerHttpClient.h"
+#include "HttpModule.h"
+#include "HttpManager.h"
+#include "Interfaces/IHttpResponse.h"
+#include "HAL/PlatformProcess.h"
+
+namespace
+{
+	struct FQueuedRequest
+	{
+		FString Verb;
+		FString Url;
+		FString Body;
+		FHttpRequestCompleteDelegate OnComplete;
+		FOpenCueHttpRequestOptions Options;
+		int32 Attempt = 0;
+	};
+
+	struct FEndpointQueue
+	{
+		/** Not sent yet, in send order. */
+		TArray<TSharedRef<FQueuedRequest>> Requests;
+
+		/** On the wire, at most FOpenCueWorkerHttpClient::MaxInFlightPerEndpoint. */
+		TArray<TSharedRef<FQueuedRequest>> InFlight;
+	};
+
+	TMap<FString, FEndpointQueue> GEndpointQueues;
+	int32 GNumPendingRequests = 0;
+
+	bool IsIdempotent(const FQueuedRequest& InRequest)
+	{
+		if (InRequest.Options.bIdempotent.IsSet())
+		{
+			return InRequest.Options.bIdempotent.GetValue();
+		}
+
+		return InRequest.Verb == TEXT("GET") || InRequest.Verb == TEXT("HEAD") || InRequest.Verb == TEXT("PUT") || InRequest.Verb == TEXT("DELETE");
+	}
+
+	FHttpRequestRef CreateRequest(const FString& InVerb, const FString& InUrl, const FString& InBody, const FOpenCueHttpRequestOptions& InOptions)
+	{
+		FHttpRequestRef Request = FHttpModule::Get().CreateRequest();
+		Request->SetURL(InUrl);
+		Request->SetVerb(InVerb);
+		Request->SetHeader(TEXT("Accept"), TEXT("application/json"));
+		Request->SetHeader(TEXT("Connection"), TEXT("keep-alive"));
+		if (!InBody.IsEmpty())
+		{
+			Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+			Request->SetContentAsString(InBody);
+		}
+		// The HTTP module default can be unlimited, which would leave a stalled request in flight forever
+		Request->SetTimeout(InOptions.TimeoutSec > 0.0f ? InOptions.TimeoutSec : FOpenCueWorkerHttpClient::DefaultTimeoutSec);
+		return Request;
+	}
+
+	void DispatchNext(const FString& InEndpoint);
+
+	void OnQueuedRequestComplete(const FString& InEndpoint, const TSharedRef<FQueuedRequest>& InItem,
+		FHttpRequestPtr InRequest, FHttpResponsePtr InResponse, bool bWasSuccessful)
+	{
+		FEndpointQueue* Queue = GEndpointQueues.Find(InEndpoint);
+		if (!Queue)
+		{
+			return;
+		}
+		Queue->InFlight.Remove(InItem);
+
+		// A kept-alive connection the server closed in the meantime fails without a response; resend on a fresh one
+		const bool bConnectionFailed = !bWasSuccessful || !InResponse.IsValid();
+		if (bConnectionFailed && IsIdempotent(*InItem) && InItem->Attempt < InItem->Options.MaxRetries)
+		{
+			++InItem->Attempt;
+			UE_LOG(LogTemp, Log, TEXT("[OpenCue] %s %s failed, retrying (%d/%d)"), *InItem->Verb, *InItem->Url, InItem->Attempt, InItem->Options.MaxRetries);
+			Queue->Requests.Insert(InItem, 0);
+			DispatchNext(InEndpoint);
+			return;
+		}
+
+		--GNumPendingRequests;
+
+		// May queue further requests, so the queue is looked up again afterwards
+		InItem->OnComplete.ExecuteIfBound(InRequest, InResponse, bWasSuccessful);
+		DispatchNext(InEndpoint);
+	}
+
+	/** A snapshot waits while an older one for the same URL is on the wire, so they can't overtake each other. */
+	bool CanDispatch(const FEndpointQueue& InQueue, const FQueuedRequest& InItem)
+	{
+		if (!InItem.Options.bCoalesce)
+		{
+			return true;
+		}
+
+		return !InQueue.InFlight.ContainsByPredicate([&InItem](const TSharedRef<FQueuedRequest>& InFlightItem)
+		{
+			return InFlightItem->Options.bCoalesce && InFlightItem->Verb == InItem.Verb && InFlightItem->Url == InItem.Url;
+		});
+	}
+
+	void DispatchNext(const FString& InEndpoint)
+	{
+		// Looked up on every pass, a request failing right away may run its completion and touch the queues
+		while (FEndpointQueue* Queue = GEndpointQueues.Find(InEndpoint))
+		{
+			if (Queue->InFlight.Num() >= FOpenCueWorkerHttpClient::MaxInFlightPerEndpoint)
+			{
+				return;
+			}
+
+			const int32 NextIndex = Queue->Requests.IndexOfByPredicate([Queue](const TSharedRef<FQueuedRequest>& InItem)
+			{
+				return CanDispatch(*Queue, *InItem);
+			});
+			if (NextIndex == INDEX_NONE)
+			{
+				return;
+			}
+
+			const TSharedRef<FQueuedRequest> Item = Queue->Requests[NextIndex];
+			Queue->Requests.RemoveAt(NextIndex);
+			Queue->InFlight.Add(Item);
+
+			FHttpRequestRef Request = CreateRequest(Item->Verb, Item->Url, Item->Body, Item->Options);
+			Request->OnProcessRequestComplete().BindLambda([InEndpoint, Item](FHttpRequestPtr InRequest, FHttpResponsePtr InResponse, bool bWasSuccessful)
+			{
+				OnQueuedRequestComplete(InEndpoint, Item, InRequest, InResponse, bWasSuccessful);
+			});
+			Request->ProcessRequest();
+		}
+	}
+}
+
+void FOpenCueWorkerHttpClient::Send(const FString& InVerb, const FString& InUrl, const FString& InBody,
+	FHttpRequestCompleteDelegate InOnComplete, const FOpenCueHttpRequestOptions& InOptions)
+{
+	check(IsInGameThread());
+
+	const FString Endpoint = InOptions.QueueKey.IsEmpty() ? GetEndpoint(InUrl) : GetEndpoint(InUrl) + TEXT("#") + InOptions.QueueKey;
+	FEndpointQueue& Queue = GEndpointQueues.FindOrAdd(Endpoint);
+
+	// Requests on the wire are neither replaced nor overtaken, only the ones still waiting
+	if (InOptions.bCoalesce)
+	{
+		for (int32 Index = 0; Index < Queue.Requests.Num(); ++Index)
+		{
+			FQueuedRequest& Queued = *Queue.Requests[Index];
+			if (Queued.Options.bCoalesce && Queued.Verb == InVerb && Queued.Url == InUrl)
+			{
+				Queued.Body = InBody;
+				Queued.OnComplete = MoveTemp(InOnComplete);
+				Queued.Options = InOptions;
+				return;
+			}
+		}
+	}
+
+	TSharedRef<FQueuedRequest> Item = MakeShared<FQueuedRequest>();
+	Item->Verb = InVerb;
+	Item->Url = InUrl;
+	Item->Body = InBody;
+	Item->OnComplete = MoveTemp(InOnComplete);
+	Item->Options = InOptions;
+
+	int32 InsertIndex = Queue.Requests.Num();
+	if (InOptions.bSendFirst)
+	{
+		InsertIndex = 0;
+		while (InsertIndex < Queue.Requests.Num() && Queue.Requests[InsertIndex]->Options.bSendFirst)
+		{
+			++InsertIndex;
+		}
+	}
+	Queue.Requests.Insert(Item, InsertIndex);
+	++GNumPendingRequests;
+
+	DispatchNext(Endpoint);
+}
+
+FHttpRequestPtr FOpenCueWorkerHttpClient::SendExclusive(const FString& InVerb, const FString& InUrl, const FString& InBody,
+	FHttpRequestCompleteDelegate InOnComplete, const FOpenCueHttpRequestOptions& InOptions)
+{
+	check(IsInGameThread());
+
+	FHttpRequestRef Request = CreateRequest(InVerb, InUrl, InBody, InOptions);
+	Request->OnProcessRequestComplete() = MoveTemp(InOnComplete);
+	Request->ProcessRequest();
+	return Request;
+}
+
+bool FOpenCueWorkerHttpClient::Flush(double InTimeoutSeconds)
+{
+	check(IsInGameThread());
+
+	const double StartTime = FPlatformTime::Seconds();
+	double LastTickTime = StartTime;
+	while (GNumPendingRequests > 0)
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Now - StartTime >= InTimeoutSeconds)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[OpenCue] %d HTTP request(s) still pending after %.1fs"), GNumPendingRequests, InTimeoutSeconds);
+			return false;
+		}
+
+		// Completion delegates (and with them the next queued request) run from the HTTP manager tick
+		FHttpModule::Get().GetHttpManager().Tick(static_cast<float>(Now - LastTickTime));
+		LastTickTime = Now;
+		FPlatformProcess::Sleep(0.005f);
+	}
+
+	return true;
+}
+
+int32 FOpenCueWorkerHttpClient::GetNumPending()
+{
+	return GNumPendingRequests;
+}
+
+FString FOpenCueWorkerHttpClient::GetEndpoint(const FString& InUrl)
+{
+	int32 HostStart = InUrl.Find(TEXT("://"));
+	HostStart = HostStart == INDEX_NONE ? 0 : HostStart + 3;
+
+	int32 HostEnd = InUrl.Find(TEXT("/"), ESearchCase::CaseSensitive, ESearchDir::FromStart, HostStart);
+	if (HostEnd == INDEX_NONE)
+	{
+		HostEnd = InUrl.Len();
+	}
+
+	return InUrl.Left(HostEnd).ToLower();
+}
@@ -0,0 +1,227 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "OpenCueWorkerStatusChannel.h"
+#include "IWebSocket.h"
+#include "WebSocketsModule.h"
+#include "Dom/JsonObject.h"
+#include "Modules/ModuleManager.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	constexpr double MinReconnectDelaySec = 1.0;
+	constexpr double MaxReconnectDelaySec = 30.0;
+
+	TSharedPtr<IWebSocket> GSocket;
+	FString GUrl;
+	FString GClientId;
+	double GNextConnectTime = 0.0;
+	double GReconnectDelaySec = MinReconnectDelaySec;
+	int64 GSequence = 0;
+
+	/** Last full record per "<type>/<job>", the base the next delta is computed against. */
+	TMap<FString, TSharedPtr<FJsonObject>> GLastRecords;
+
+	void ClearSocketHandlers()
+	{
+		GSocket->OnConnected().Clear();
+		GSocket->OnConnectionError().Clear();
+		GSocket->OnClosed().Clear();
+		GSocket->OnMessage().Clear();
+	}
+
+	bool SendJson(const TSharedRef<FJsonObject>& InRecord)
+	{
+		FString Message;
+		TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Message);
+		if (!FJsonSerializer::Serialize(InRecord, Writer))
+		{
+			return false;
+		}
+
+		GSocket->Send(Message);
+		return true;
+	}
+
+	void OpenSocket()
+	{
+		GNextConnectTime = FPlatformTime::Seconds() + GReconnectDelaySec;
+		GReconnectDelaySec = FMath::Min(GReconnectDelaySec * 2.0, MaxReconnectDelaySec);
+
+		if (GSocket.IsValid())
+		{
+			ClearSocketHandlers();
+			GSocket->Close();
+		}
+
+		GSocket = FModuleManager::LoadModuleChecked<FWebSocketsModule>(TEXT("WebSockets")).CreateWebSocket(GUrl);
+		GSocket->OnConnected().AddLambda([]()
+		{
+			UE_LOG(LogTemp, Log, TEXT("[OpenCue] Status channel connected: %s"), *GUrl);
+			GReconnectDelaySec = MinReconnectDelaySec;
+
+			// The server lost our delta base with the old connection
+			GLastRecords.Reset();
+
+			TSharedRef<FJsonObject> Hello = MakeShared<FJsonObject>();
+			Hello->SetStringField(TEXT("t"), TEXT("hello"));
+			Hello->SetStringField(TEXT("client_id"), GClientId);
+			Hello->SetNumberField(TEXT("version"), 1);
+			SendJson(Hello);
+		});
+		GSocket->OnConnectionError().AddLambda([](const FString& InError)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[OpenCue] Status channel error: %s, using REST until it reconnects"), *InError);
+		});
+		GSocket->OnClosed().AddLambda([](int32 InStatusCode, const FString& InReason, bool bWasClean)
+		{
+			UE_LOG(LogTemp, Log, TEXT("[OpenCue] Status channel closed (%d %s), using REST until it reconnects"), InStatusCode, *InReason);
+		});
+		GSocket->OnMessage().AddLambda([](const FString& InMessage)
+		{
+			TSharedPtr<FJsonObject> Record;
+			const TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(InMessage);
+			if (!FJsonSerializer::Deserialize(Reader, Record) || !Record.IsValid() || !Record->HasTypedField<EJson::String>(TEXT("t")))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("[OpenCue] Ignoring malformed status channel record: %s"), *InMessage.Left(256));
+				return;
+			}
+
+			FOpenCueWorkerStatusChannel::OnRecordReceived().Broadcast(Record->GetStringField(TEXT("t")), Record.ToSharedRef());
+		});
+		GSocket->Connect();
+	}
+
+	bool EnsureConnected()
+	{
+		if (GUrl.IsEmpty())
+		{
+			return false;
+		}
+
+		if (GSocket.IsValid() && GSocket->IsConnected())
+		{
+			return true;
+		}
+
+		if (FPlatformTime::Seconds() >= GNextConnectTime)
+		{
+			OpenSocket();
+		}
+		return false;
+	}
+
+	bool SendRecord(const TCHAR* InType, const FString& InJobId, const TSharedRef<FJsonObject>& InFields, bool bSendUnchanged)
+	{
+		check(IsInGameThread());
+		if (!EnsureConnected())
+		{
+			return false;
+		}
+
+		TSharedPtr<FJsonObject>& LastFields = GLastRecords.FindOrAdd(FString::Printf(TEXT("%s/%s"), InType, *InJobId));
+
+		TSharedRef<FJsonObject> Record = MakeShared<FJsonObject>();
+		int32 NumChanged = 0;
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : InFields->Values)
+		{
+			const TSharedPtr<FJsonValue>* LastValue = LastFields.IsValid() ? LastFields->Values.Find(Field.Key) : nullptr;
+			if (!LastValue || !LastValue->IsValid() || !Field.Value.IsValid() || !FJsonValue::CompareEqual(**LastValue, *Field.Value))
+			{
+				Record->SetField(Field.Key, Field.Value);
+				++NumChanged;
+			}
+		}
+
+		if (NumChanged == 0 && !bSendUnchanged)
+		{
+			return true;
+		}
+
+		Record->SetStringField(TEXT("t"), InType);
+		Record->SetNumberField(TEXT("seq"), static_cast<double>(++GSequence));
+		if (!InJobId.IsEmpty())
+		{
+			Record->SetStringField(TEXT("job"), InJobId);
+		}
+		if (!LastFields.IsValid())
+		{
+			Record->SetBoolField(TEXT("full"), true);
+		}
+
+		if (!SendJson(Record))
+		{
+			return false;
+		}
+
+		// Copy, the caller may keep modifying its object
+		LastFields = MakeShared<FJsonObject>(*InFields);
+		return true;
+	}
+}
+
+void FOpenCueWorkerStatusChannel::Connect(const FString& InUrl, const FString& InClientId)
+{
+	check(IsInGameThread());
+	if (InUrl.IsEmpty() || (InUrl == GUrl && GSocket.IsValid()))
+	{
+		return;
+	}
+
+	GUrl = InUrl;
+	GClientId = InClientId;
+	GReconnectDelaySec = MinReconnectDelaySec;
+	OpenSocket();
+}
+
+void FOpenCueWorkerStatusChannel::Disconnect()
+{
+	check(IsInGameThread());
+	if (GSocket.IsValid())
+	{
+		ClearSocketHandlers();
+		GSocket->Close();
+		GSocket.Reset();
+	}
+
+	GUrl.Reset();
+	GLastRecords.Reset();
+}
+
+bool FOpenCueWorkerStatusChannel::IsConnected()
+{
+	return GSocket.IsValid() && GSocket->IsConnected();
+}
+
+bool FOpenCueWorkerStatusChannel::SendHeartbeat(const TSharedRef<FJsonObject>& InFields)
+{
+	return SendRecord(TEXT("hb"), FString(), InFields, true);
+}
+
+bool FOpenCueWorkerStatusChannel::SendState(const FString& InJobId, const FString& InState)
+{
+	TSharedRef<FJsonObject> Fields = MakeShared<FJsonObject>();
+	Fields->SetStringField(TEXT("state"), InState);
+	const bool bSent = SendRecord(TEXT("state"), InJobId, Fields, true);
+
+	// Nothing is computed against the job's records after this, a persistent worker would otherwise keep them forever.
+	// A later state (e.g. encoded after completed) is sent as a full record.
+	if (InState == TEXT("completed") || InState == TEXT("failed") || InState == TEXT("encoded") || InState == TEXT("encode_failed"))
+	{
+		GLastRecords.Remove(FString::Printf(TEXT("progress/%s"), *InJobId));
+		GLastRecords.Remove(FString::Printf(TEXT("state/%s"), *InJobId));
+	}
+	return bSent;
+}
+
+bool FOpenCueWorkerStatusChannel::SendProgress(const FString& InJobId, const TSharedRef<FJsonObject>& InFields)
+{
+	return SendRecord(TEXT("progress"), InJobId, InFields, false);
+}
+
+FOpenCueWorkerStatusChannel::FOnRecordReceived& FOpenCueWorkerStatusChannel::OnRecordReceived()
+{
+	static FOnRecordReceived Delegate;
+	return Delegate;
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+#include "OpenCueEncoderBenchmarkCommandlet.h"
+#include "MoviePipelineCustomEncoder.h"
+#include "MoviePipelineCommandLineEncoderSettings.h"
+#include "MoviePipelineIntermediateFileCleanup.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOpenCueStandaloneEncodeTest, "OpenCue.Encoder.StandaloneEncode",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::ProductFilter)
+
+bool FOpenCueStandaloneEncodeTest::RunTest(const FString& Parameters)
+{
+	// Build machines without ffmpeg skip the test instead of failing it
+	FString Executable = GetDefault<UMoviePipelineCommandLineEncoderSettings>()->ExecutablePath.Replace(TEXT("\""), TEXT(""));
+	FPaths::NormalizeFilename(Executable);
+	int32 ReturnCode = -1;
+	if (Executable.IsEmpty() || !FPlatformProcess::ExecProcess(*Executable, TEXT("-hide_banner -version"), &ReturnCode, nullptr, nullptr) || ReturnCode != 0)
+	{
+		AddInfo(FString::Printf(TEXT("Encoder '%s' is not installed, skipping."), *Executable));
+		return true;
+	}
+
+	const FString WorkingDirectory = FPaths::ProjectSavedDir() / TEXT("Automation") / TEXT("OpenCueStandaloneEncode");
+	IFileManager::Get().DeleteDirectory(*WorkingDirectory, false, true);
+
+	TArray<FString> FramePaths;
+	int64 InputBytes = 0;
+	if (!TestTrue(TEXT("Synthetic frames written"), UOpenCueEncoderBenchmarkCommandlet::WriteSyntheticFrames(WorkingDirectory / TEXT("Frames"), 64, 64, 8, TEXT("png"), FramePaths, InputBytes)))
+	{
+		return false;
+	}
+
+	UMoviePipelineCustomEncoder* Encoder = NewObject<UMoviePipelineCustomEncoder>(GetTransientPackage());
+	Encoder->bDeleteSourceFiles = false;
+	Encoder->Quality = EMoviePipelineEncodeQuality::Low;
+
+	FMoviePipelineStandaloneEncodeRequest Request;
+	Request.VideoFiles = FramePaths;
+	Request.FrameRate = 24.0;
+	Request.OutputPathNoExtension = WorkingDirectory / TEXT("StandaloneEncode");
+	Request.WorkingDirectory = WorkingDirectory;
+
+	TArray<FString> OutputPaths;
+	TestTrue(TEXT("Encode succeeded"), Encoder->EncodeStandaloneBlocking(Request, OutputPaths));
+	if (TestEqual(TEXT("Number of outputs"), OutputPaths.Num(), 1))
+	{
+		TestTrue(TEXT("Output written"), IFileManager::Get().FileSize(*OutputPaths[0]) > 0);
+	}
+
+	FMoviePipelineIntermediateFileCleanup::WaitForPendingDeletes(10.0);
+	IFileManager::Get().DeleteDirectory(*WorkingDirectory, false, true);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Joins the fragments of a render that was split into frame range chunks (see UMoviePipelineCustomEncoder::bEncodeAsChunk)
+ * into the final files. Chunks live in "<start>-<end>" sub directories of one job directory, <end> being the last frame
+ * of the chunk (inclusive), so consecutive chunks are e.g. 0-99 and 100-199. Video is stream-copied,
+ * the audio of all chunks is encoded once.
+ */
+class OPENCUEFORUNREALUTILS_API FMoviePipelineChunkStitcher
+{
+public:
+	struct FChunk
+	{
+		int32 StartFrame = 0;
+		int32 EndFrame = 0;
+		FString Directory;
+	};
+
+	/**
+	 * File in each chunk directory listing the fragment file names of that chunk, one per line. Chunks encoded before
+	 * it was written fall back to the files with the Project Settings output extension.
+	 */
+	static const TCHAR* FragmentListFileName;
+
+	/** Find the chunk directories below InJobDirectory, sorted by start frame. */
+	static TArray<FChunk> FindChunks(const FString& InJobDirectory);
+
+	/**
+	 * Stitch every video file name found in the chunks into InOutputDirectory, using the encoder executable and audio codec
+	 * from the Command Line Encoder Project Settings. Fails on gaps or overlaps between chunks unless bInAllowGaps is set.
+	 */
+	static bool Stitch(const FString& InJobDirectory, const FString& InOutputDirectory, const bool bInAllowGaps, TArray<FString>& OutOutputPaths);
+};
@@ -7,8 +7,66 @@
 #include "MoviePipelineCommandLineEncoder.h"
 #include "Engine/EngineTypes.h"
 #include "MovieRenderPipelineDataTypes.h"
+#include "MoviePipelineEncoderProgress.h"
 #include "MoviePipelineCustomEncoder.generated.h"
 
+class FMoviePipelineEncoderPipeReader;
+
+/**
+ * One file produced by the encoder. All targets of a render pass are encoded by a single process that
+ * decodes the source frames once and splits them, so a master and a review proxy cost one read of the frames.
+ */
+USTRUCT(BlueprintType)
+struct OPENCUEFORUNREALUTILS_API FMoviePipelineEncoderOutputTarget
+{
+	GENERATED_BODY()
+
+	/** Name of this output. Available as {output_target} in the file name format, otherwise appended to the file name. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
+	FString Name;
+
+	/** Video codec for this output. Uses the codec from Project Settings if empty. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
+	FString VideoCodec;
+
+	/** Encoding quality for this output. Exact command line arguments for each one are specified in Project Settings. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
+	EMoviePipelineEncodeQuality Quality = EMoviePipelineEncodeQuality::Epic;
+
+	/** Scale applied to the rendered resolution, e.g. 0.5 for a half-resolution review proxy. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder", meta = (ClampMin = "0.01", UIMin = "0.01", UIMax = "1.0"))
+	float ResolutionScale = 1.f;
+
+	/** File extension for this output. Uses the extension from Project Settings if empty. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
+	FString FileExtension;
+
+	/** Any additional arguments to pass to the CLI encode for this output only. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
+	FString AdditionalArgs;
+};
+
+/**
+ * Frames already on disk to encode without a movie pipeline, e.g. for benchmarks or re-encoding retained frames.
+ */
+struct OPENCUEFORUNREALUTILS_API FMoviePipelineStandaloneEncodeRequest
+{
+	/** Frames in playback order. */
+	TArray<FString> VideoFiles;
+
+	/** Optional wav files, muxed into every output. */
+	TArray<FString> AudioFiles;
+
+	/** Frame rate the frames were rendered at. */
+	double FrameRate = 24.0;
+
+	/** Output file without extension. Output targets get their name appended. */
+	FString OutputPathNoExtension;
+
+	/** Directory for the generated input lists. Uses the output directory if empty. */
+	FString WorkingDirectory;
+};
+
 /**
  * 
  */
@@ -26,6 +84,15 @@ class OPENCUEFORUNREALUTILS_API UMoviePipelineCustomEncoder : public UMoviePipel
 		TMap<FString, TArray<FString>> FilesByExtensionType;
 		TWeakObjectPtr<class UMoviePipelineExecutorShot> Shot;
 		int32 ExpectedFrameCount;
+
+		/** Resolved output file per output target (a single entry when no targets are defined). */
+		TArray<FString> OutputPaths;
+
+		/** Audio that was already encoded once for all render passes, stream-copied instead of re-encoding the wav files. */
+		FString AudioIntermediatePath;
+
+		/** Directory for generated input lists when encoding without a pipeline. */
+		FString WorkingDirectory;
 	};
 
 	GENERATED_BODY()
@@ -44,12 +111,38 @@ public:
 	virtual bool IsValidOnPrimary() const override { return true; }
 	virtual bool HasFinishedExportingImpl() override;
 	virtual void BeginExportImpl() override;
+
+	/**
+	* Latest structured progress reported by the encoder processes (frame, fps, speed). While several
+	* render passes encode at once the values are combined. Returns false if nothing was reported yet.
+	*/
+	bool GetEncoderProgress(FMoviePipelineEncoderProgress& OutProgress) const;
+
+	/**
+	* Encode InRequest with the settings of this object without a movie pipeline. Call TickStandaloneEncode until
+	* it returns false. Returns false if the encoder could not be launched.
+	*/
+	bool StartStandaloneEncode(const FMoviePipelineStandaloneEncodeRequest& InRequest, TArray<FString>& OutOutputPaths);
+
+	/** Ticks encodes started by StartStandaloneEncode. Returns true while any of them is still running. */
+	bool TickStandaloneEncode();
+
+	/** StartStandaloneEncode and tick until done, for commandlets. Returns true if every encoder exited cleanly and every output was written. */
+	bool EncodeStandaloneBlocking(const FMoviePipelineStandaloneEncodeRequest& InRequest, TArray<FString>& OutOutputPaths);
+
+	/** True if an encoder process of this object exited with an error (cancellations excluded). */
+	bool HasEncodeFailed() const { return bEncodeFailed; }
+
+	/** Every file the encodes of the current or last pipeline write. */
+	const TArray<FString>& GetOutputPaths() const { return PipelineOutputPaths; }
 	
 protected:
 	bool NeedsPerShotFlushing() const;
 	void LaunchEncoder(const FEncoderParams& InParams);
 	void OnTick();
 	FString GetQualitySettingString() const;
+	static FString GetQualitySettingString(const EMoviePipelineEncodeQuality InQuality);
+	FStringFormatNamedArguments MakeSharedArguments(const double InFrameRate) const;
 
 public:
 	/** 
@@ -73,6 +166,33 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
 	bool bDeleteSourceFiles;
 
+	/**
+	* Encode one chunk of a render that was split across hosts, so the fragments can be stream-copied into one file by
+	* UOpenCueStitchCommandlet. Uses fixed closed GOPs with a keyframe on the first frame and a fixed timescale. The audio
+	* is not encoded into the fragment but moved next to it, the stitch encodes it once for the whole sequence.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder|Chunk")
+	bool bEncodeAsChunk;
+
+	/** Keyframe interval in frames for chunk encodes, 0 uses one second. Has to be the same for all chunks of a job. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder|Chunk", meta = (ClampMin = "0", EditCondition = "bEncodeAsChunk"))
+	int32 ChunkGopSize;
+
+	/**
+	* Keep the rendered frames after encoding, even if bDeleteSourceFiles is set, so they can be encoded again later without
+	* rendering (see UOpenCueEncodeOnlyCommandlet). A manifest is written next to the frames and they are deleted once
+	* SourceFrameRetentionHours passed.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
+	bool bRetainSourceFrames;
+
+	/**
+	* How long retained frames are kept. Expired frames below Saved/MovieRenders are deleted in the background by the next
+	* encode that retains frames, frames elsewhere by UOpenCueEncodeOnlyCommandlet -SweepExpired=<dir>.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder", meta = (ClampMin = "0.0", EditCondition = "bRetainSourceFrames"))
+	float SourceFrameRetentionHours;
+
 	/** If a render was canceled (via hitting escape mid render) should we skip trying to encode the files we did produce? */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
 	bool bSkipEncodeOnRenderCanceled;
@@ -80,13 +200,67 @@ public:
 	/** Write the duration for each frame into the generated text file. Needed for some input types on some CLI encoding software. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
 	bool bWriteEachFrameDuration;
+
+	/**
+	* If the rendered frames form a gap-free numbered sequence (e.g. {sequence_name}.{frame_number}), pass them to the
+	* encoder as an image2 pattern with -start_number and -framerate instead of a per-file list. Sequences with gaps
+	* still use the generated file list.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
+	bool bUseImageSequencePattern;
+
+	/**
+	* Input arguments for the image sequence pattern, with {InputFile}, {StartNumber} and {FrameRate}. If empty, the
+	* Project Settings Video Input String Format is used with its concat demuxer swapped for image2, so input options
+	* configured there (e.g. -apply_trc) still apply. Formats without "-f concat" then keep using the file list.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder", meta = (EditCondition = "bUseImageSequencePattern"))
+	FString ImageSequenceInputStringFormat;
+
+	/**
+	* Optional list of outputs to produce from every render pass, e.g. a full quality master and a half resolution proxy.
+	* They are produced by one encoder process that reads the frames once. If empty, a single file is produced using
+	* Quality, AdditionalCommandLineArgs and the Project Settings command line format.
+	*
+	* With targets, the Project Settings command line is split at {AudioInputs}: what comes before it is kept as is,
+	* what comes after it is repeated for every target behind a -map of its split branch, with the target's
+	* AdditionalArgs in front of {OutputPath}. Formats without {AudioInputs} followed by {OutputPath} use a built-in
+	* command line instead. Render passes with more than one video input fail to encode.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder")
+	TArray<FMoviePipelineEncoderOutputTarget> OutputTargets;
+
+	/**
+	* Keep the encode of each render pass within EncodeTimeBudgetSeconds. The encoder speed is measured over the first
+	* EncodeBudgetProbeFrames frames and if the projected duration exceeds the budget the encode is restarted with a
+	* faster preset from EncodeBudgetPresetLadder.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder|Time Budget")
+	bool bUseEncodeTimeBudget;
+
+	/** Wall-clock seconds the encode of a render pass may take, including the probe. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder|Time Budget", meta = (ClampMin = "1.0", EditCondition = "bUseEncodeTimeBudget"))
+	float EncodeTimeBudgetSeconds;
+
+	/** Number of frames encoded before the speed is measured. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder|Time Budget", meta = (ClampMin = "1", EditCondition = "bUseEncodeTimeBudget"))
+	int32 EncodeBudgetProbeFrames;
+
+	/**
+	* Values passed as -preset, ordered from slowest to fastest. If the quality setting already contains one of them the
+	* search starts there, otherwise at the beginning of the list.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Command Line Encoder|Time Budget", meta = (EditCondition = "bUseEncodeTimeBudget"))
+	TArray<FString> EncodeBudgetPresetLadder;
 	
 private:
 	struct FActiveJob
 	{
 		FActiveJob()
-			: ReadPipe(nullptr)
-			, WritePipe(nullptr)
+			: ProgressReadPipe(nullptr)
+			, ProgressWritePipe(nullptr)
+			, ErrorReadPipe(nullptr)
+			, ErrorWritePipe(nullptr)
 			, ExpectedFrameCount(0)
 			, LastReportedFrame(0)
 			, LastProgressSentTimeSeconds(-1.0)
@@ -95,19 +269,123 @@ private:
 		{}
 
 		FProcHandle ProcessHandle;
-		void* ReadPipe;
-		void* WritePipe;
+
+		/** Id of the encoder process, 0 if unknown. Used to sample its resource usage. */
+		uint32 ProcessId = 0;
+
+		/** stdout of the encoder, carrying the -progress key=value stream. */
+		void* ProgressReadPipe;
+		void* ProgressWritePipe;
+
+		/** stderr of the encoder, only real diagnostics end up here. */
+		void* ErrorReadPipe;
+		void* ErrorWritePipe;
 
 		int32 ExpectedFrameCount;
 		int32 LastReportedFrame;
 		double LastProgressSentTimeSeconds;
 		double EncodeStartTimeSeconds;
 		double LastReportedEtaSeconds;
-		FString PendingStdOut;
+		/** Drains both pipes on a background thread and hands parsed records to OnTick. */
+		TSharedPtr<FMoviePipelineEncoderPipeReader> PipeReader;
+		FMoviePipelineEncoderProgress Progress;
 		TWeakObjectPtr<UMoviePipelineExecutorShot> Shot;
 
 		TArray<FString> FilesToDelete;
+
+		FGuid JobId;
+
+		/** True for the shared audio encode that render pass jobs wait on. */
+		bool bIsAudioPreEncode = false;
+
+		/** Shared audio intermediate this job reads from, released once the job is done. */
+		FString AudioIntermediatePath;
+
+		/** Source wav files of an audio pre-encode, only deleted if the pre-encode succeeded. */
+		TArray<FString> SourceAudioFiles;
+
+		/** Executable and arguments the job was launched with. {EncodePreset} marks where a preset override goes. */
+		FString Executable;
+		FString CommandLineTemplate;
+
+		/**
+		* Position in EncodeBudgetPresetLadder the job encodes at. While Progress.Preset is empty this is only where the
+		* quality setting is assumed to sit.
+		*/
+		int32 PresetIndex = INDEX_NONE;
+
+		/** Time the first process for this job started, a restart with a faster preset keeps counting from here. */
+		double BudgetStartTimeSeconds = -1.0;
+
+		/** Frame count at which the speed is measured next, 0 once the budget needs no further checks. */
+		int32 NextBudgetCheckFrame = 0;
+	};
+
+	/** A render pass encode waiting for the shared audio pre-encode it depends on. */
+	struct FPendingEncode
+	{
+		FEncoderParams Params;
+		FGuid AudioJobId;
 	};
 
+	/** Create the pipes and pipe reader for an encoder process and launch it. Returns false if the process could not be started. */
+	bool StartEncoderProcess(const FString& InExecutable, const FString& InCommandLineArgs, FActiveJob& OutJob);
+
+	/** Encode InAudioFiles once into InIntermediatePath so every render pass can stream-copy the result. */
+	bool LaunchAudioPreEncode(const FGuid& InJobId, const TArray<FString>& InAudioFiles, const FString& InIntermediatePath, const FStringFormatNamedArguments& InSharedArguments);
+
+	/** Launch the render pass encodes that waited on an audio pre-encode, falling back to the wav files if it failed. */
+	void OnAudioPreEncodeFinished(const FGuid& InJobId, const FString& InIntermediatePath, const bool bSucceeded);
+
+	/** Generated input lists and intermediates are kept when the debug setting asks to write all samples. */
+	bool ShouldDeleteGeneratedInputs() const;
+
+	/** bDeleteSourceFiles, unless the frames are retained for a later re-encode. */
+	bool ShouldDeleteSourceFiles() const;
+
+	/** ImageSequenceInputStringFormat or the one derived from the Project Settings, empty if there is none. */
+	FString GetImageSequenceInputStringFormat() const;
+
+	/** Output arguments that make a chunk's fragment concatenable, empty unless bEncodeAsChunk is set. */
+	FString GetChunkEncodeArgs(const double InFrameRate, const FString& InExtension) const;
+
+	/** Move the audio of a chunk next to its fragment and take it out of the encode. Files already moved are skipped. */
+	void MoveChunkAudio(FEncoderParams& InOutParams);
+
+	/** List the fragments of every chunk directory written so far, so the stitcher doesn't pick up frames next to them. */
+	void WriteChunkFragmentLists() const;
+
+	/** Hand the running encodes to FMoviePipelineDetachedEncodes so the pipeline can finish without waiting for them. */
+	void DetachActiveEncodes();
+
+	/** Record the frames of a render pass so UOpenCueEncodeOnlyCommandlet can encode them again. */
+	void WriteRetainedFramesManifest(const FEncoderParams& InParams) const;
+
+	/** Path for a file the encoder generates (input lists), in the working directory or the pipeline's output directory. */
+	FString ResolveGeneratedFilePath(const FEncoderParams& InParams, const FString& InBaseName, const FString& InExtension) const;
+
+	/** Restart InOutJob with a faster preset if the measured speed can't meet the time budget. */
+	void UpdateEncodeTimeBudget(FActiveJob& InOutJob);
+
+	/** Ladder index of the -preset already present in InQualityString, INDEX_NONE if there is none. */
+	int32 FindPresetInLadder(const FString& InQualityString) const;
+
 	TArray<FActiveJob> ActiveEncodeJobs;
+	TArray<FPendingEncode> PendingEncodeJobs;
+
+	/** Number of render pass jobs still reading each audio intermediate. */
+	TMap<FString, int32> AudioIntermediateRefCounts;
+
+	/** Every file the pipeline's encodes write, reported when they are detached. */
+	TArray<FString> PipelineOutputPaths;
+
+	/** Chunk audio already moved, and how many files each chunk directory got, across all shots and render passes. */
+	TSet<FString> MovedChunkAudioFiles;
+	TMap<FString, int32> ChunkAudioCountByDirectory;
+
+	bool bEncodeFailed = false;
+
+	/** Progress of the most recently finished encode job, reported once no job is active anymore. */
+	FMoviePipelineEncoderProgress LastEncoderProgress;
+	bool bHasEncoderProgress = false;
 };
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Delegates/Delegate.h"
+
+class UMoviePipelineCustomEncoder;
+
+/**
+ * Encodes that outlive their movie pipeline. When enabled, UMoviePipelineCustomEncoder hands its running encoder
+ * processes over here at the end of Export instead of holding the pipeline until they exit, so a persistent worker
+ * can start rendering its next task while the previous one still encodes.
+ *
+ * The adopted encodes are ticked from the core ticker on the game thread; source frames are deleted as usual once
+ * an encode finished. Game thread only.
+ */
+class OPENCUEFORUNREALUTILS_API FMoviePipelineDetachedEncodes
+{
+public:
+	/** Called on the game thread once every encode adopted for a job has exited. */
+	DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnDetachedEncodeFinished, const FString& /*JobId*/, bool /*bSuccess*/, const TArray<FString>& /*OutputPaths*/);
+
+	/** Off by default; pipelines then wait for their encodes like stock MRQ. */
+	static void SetEnabled(bool bInEnabled);
+	static bool IsEnabled();
+
+	/** Take over InEncoder (an encoder no pipeline references anymore) and tick it until its encodes exited. */
+	static void Adopt(UMoviePipelineCustomEncoder* InEncoder, const FString& InJobId, const TArray<FString>& InOutputPaths);
+
+	/**
+	 * Tick the adopted encodes until all finished or the timeout elapsed, e.g. before the process exits.
+	 * @return true if nothing is pending anymore.
+	 */
+	static bool WaitForAll(double InTimeoutSeconds);
+
+	/** Number of jobs whose encodes are still running. */
+	static int32 GetNumActive();
+
+	/** True while encodes adopted for InJobId are running; OnFinished reports the job once they exited. */
+	static bool IsEncoding(const FString& InJobId);
+
+	static FOnDetachedEncodeFinished& OnFinished();
+};
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Snapshot of the structured key=value stream ffmpeg writes with "-progress".
+ * Values that ffmpeg reports as N/A are left at their defaults.
+ */
+struct OPENCUEFORUNREALUTILS_API FMoviePipelineEncoderProgress
+{
+	/** Number of frames written so far. */
+	int32 Frame = 0;
+
+	/** Frames the encode is expected to produce, 0 if unknown. */
+	int32 ExpectedFrameCount = 0;
+
+	/** Encoder throughput in frames per second. */
+	double Fps = 0.0;
+
+	/** Encoder speed relative to real time (1.0 == real time). */
+	double Speed = 0.0;
+
+	/** Output timestamp in microseconds. */
+	int64 OutTimeUs = 0;
+
+	/** True once ffmpeg reported progress=end. */
+	bool bEnded = false;
+
+	/** Preset chosen by the time budget, empty if the quality setting is used as is. */
+	FString Preset;
+
+	/**
+	 * Resource usage of the encoder process, sampled from /proc while it runs (Linux only), -1 if unknown.
+	 * ReadBytes counts everything the encoder read, StorageReadBytes only what missed the page cache.
+	 */
+	int64 PeakResidentBytes = -1;
+	int64 ReadBytes = -1;
+	int64 StorageReadBytes = -1;
+
+	/** Returns the completion ratio in [0, 1], or -1 if the expected frame count is unknown. */
+	float GetCompletion() const
+	{
+		if (ExpectedFrameCount <= 0)
+		{
+			return -1.f;
+		}
+		return FMath::Clamp(static_cast<float>(Frame) / static_cast<float>(ExpectedFrameCount), 0.f, 1.f);
+	}
+};
+
+/**
+ * Incremental parser for the "-progress" stream. Lines are fed one at a time and a block is
+ * considered complete once the "progress=" key is seen, which ffmpeg always writes last.
+ */
+class OPENCUEFORUNREALUTILS_API FMoviePipelineEncoderProgressParser
+{
+public:
+	/** Parse a single key=value line. Returns true if the line closed a progress block. */
+	bool ParseLine(FStringView Line);
+
+	/** Values accumulated so far. Only consistent right after ParseLine returned true. */
+	const FMoviePipelineEncoderProgress& GetCurrent() const { return Current; }
+
+private:
+	FMoviePipelineEncoderProgress Current;
+};
+
+/**
+ * Accumulates raw pipe output and hands back complete lines without re-allocating the pending
+ * buffer for every chunk. Both '\n' and '\r' terminate a line.
+ */
+class OPENCUEFORUNREALUTILS_API FMoviePipelineEncoderLineBuffer
+{
+public:
+	/** Append a chunk and invoke InLineCallback for every complete, non-empty line. */
+	template<typename CallbackType>
+	void Consume(const FString& InChunk, CallbackType&& InLineCallback)
+	{
+		if (InChunk.IsEmpty())
+		{
+			return;
+		}
+
+		Pending += InChunk;
+
+		int32 LineStart = 0;
+		for (int32 Index = 0; Index < Pending.Len(); ++Index)
+		{
+			const TCHAR Char = Pending[Index];
+			if (Char != TEXT('\n') && Char != TEXT('\r'))
+			{
+				continue;
+			}
+
+			const FStringView Line = FStringView(*Pending + LineStart, Index - LineStart).TrimStartAndEnd();
+			if (!Line.IsEmpty())
+			{
+				InLineCallback(Line);
+			}
+			LineStart = Index + 1;
+		}
+
+		if (LineStart > 0)
+		{
+			Pending.RemoveAt(0, LineStart, false);
+		}
+	}
+
+	/** Hand back whatever is left as a final line (used once the process exited). */
+	template<typename CallbackType>
+	void Flush(CallbackType&& InLineCallback)
+	{
+		const FStringView Remainder = FStringView(Pending).TrimStartAndEnd();
+		if (!Remainder.IsEmpty())
+		{
+			InLineCallback(Remainder);
+		}
+		Pending.Reset();
+	}
+
+private:
+	FString Pending;
+};
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Delegates/Delegate.h"
+
+/**
+ * Deletes intermediate render/encode files on background tasks so the game thread does not hitch on
+ * thousands of individual deletes (especially on network shares) right before the process exits.
+ *
+ * Files are deleted one by one on the background task. A directory is removed afterwards only if it is
+ * empty then, so files written into it meanwhile (the next shot, another pass) are never touched.
+ */
+class OPENCUEFORUNREALUTILS_API FMoviePipelineIntermediateFileCleanup
+{
+public:
+	/** Called on the game thread once a batch finished. */
+	DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnCleanupFinished, const FString& /*Label*/, int32 /*NumDeleted*/, int32 /*NumFailed*/);
+
+	/** Queue a batch of files for deletion. Label is only used for logging and the completion delegate. */
+	static void DeleteAsync(TArray<FString>&& InFiles, const FString& InLabel);
+
+	/**
+	 * Block until every queued batch finished or the timeout elapsed.
+	 * @return true if nothing is pending anymore.
+	 */
+	static bool WaitForPendingDeletes(double InTimeoutSeconds);
+
+	/** Number of batches that have not finished yet. */
+	static int32 GetNumPendingBatches();
+
+	static FOnCleanupFinished& OnCleanupFinished();
+};
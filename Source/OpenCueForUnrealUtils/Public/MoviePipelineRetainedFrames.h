@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMoviePipelineStandaloneEncodeRequest;
+
+/**
+ * Manifests for rendered frames that are kept after the encode, so the frames can be encoded again later
+ * (different codec or bitrate) without rendering the job again. A manifest sits next to the frames it
+ * describes and records when they may be deleted.
+ */
+class OPENCUEFORUNREALUTILS_API FMoviePipelineRetainedFrames
+{
+public:
+	/** Suffix of every manifest file, used to find them when sweeping. */
+	static const TCHAR* ManifestSuffix;
+
+	/**
+	 * Write a manifest for InRequest into the directory of its first frame. Paths are stored relative to the manifest
+	 * so the directory can be moved as a whole. Returns the manifest path, or an empty string if writing failed.
+	 */
+	static FString WriteManifest(const FMoviePipelineStandaloneEncodeRequest& InRequest, double InRetentionHours);
+
+	/** Read a manifest back into a request that can be handed to UMoviePipelineCustomEncoder::StartStandaloneEncode. */
+	static bool ReadManifest(const FString& InManifestPath, FMoviePipelineStandaloneEncodeRequest& OutRequest, FDateTime& OutExpiresUtc);
+
+	/**
+	 * Queue the frames of every expired manifest below InRootDirectory for background deletion, together with the manifest.
+	 * @return number of expired manifests found.
+	 */
+	static int32 DeleteExpired(const FString& InRootDirectory);
+
+	/** DeleteExpired on a background task. Skipped while an earlier sweep is still scanning. */
+	static void DeleteExpiredAsync(const FString& InRootDirectory);
+
+	/** Where renders go unless a job overrides its output directory: <Project>/Saved/MovieRenders. */
+	static FString GetDefaultSweepDirectory();
+};
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "OpenCueEncodeOnlyCommandlet.generated.h"
+
+/**
+ * Encode-only task: encodes frames that a previous render retained (UMoviePipelineCustomEncoder::bRetainSourceFrames)
+ * without loading a map or rendering, so a delivery re-encode with a different codec or bitrate only costs the encode.
+ * Runs as a lightweight commandlet process instead of a full render session:
+ *
+ *   UnrealEditor-Cmd <Project> -run=OpenCueEncodeOnly -nullrhi -unattended
+ *       -Manifest=<frames dir>/<name>.opencue-frames.json | -FramesDir=<dir> -FrameRate=<fps>
+ *       [-Output=<path without extension>] [-Quality=Low|Medium|High|Epic] [-ExtraArgs="..."]
+ *       [-VideoCodec=<codec>] [-AudioCodec=<codec>] [-Extension=<ext>] [-Executable=<ffmpeg>]
+ *       [-SweepExpired[=<dir>]]
+ *
+ * Codec, extension and executable default to the Command Line Encoder Project Settings. -Output defaults to the
+ * output path recorded in the manifest with a _reencode suffix, so the original delivery is kept. -SweepExpired
+ * deletes expired retained frames below the directory first, <Project>/Saved/MovieRenders without a value.
+ *
+ * Returns 0 if the encode succeeded.
+ */
+UCLASS()
+class OPENCUEFORUNREALUTILS_API UOpenCueEncodeOnlyCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UOpenCueEncodeOnlyCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "OpenCueEncoderBenchmarkCommandlet.generated.h"
+
+/**
+ * Benchmarks UMoviePipelineCustomEncoder against the locally installed encoder without rendering anything.
+ * Synthetic frames are written to disk and encoded through the standalone encode path, then wall time,
+ * throughput, encoder fps/speed, input/output sizes and, on Linux, the encoder's peak memory and bytes read are
+ * logged and optionally appended to a CSV.
+ * Needs no GPU, so it runs headless on a Linux CI box:
+ *
+ *   UnrealEditor-Cmd <Project> -run=OpenCueEncoderBenchmark -nullrhi -unattended
+ *       [-Width=1920] [-Height=1080] [-Frames=240] [-FrameRate=24] [-Format=png|jpg|bmp]
+ *       [-Quality=Low,Epic] [-Iterations=1] [-ExtraArgs="..."] [-Executable=<ffmpeg>]
+ *       [-OutputDir=<dir>] [-Report=<csv>] [-NoPattern] [-KeepFiles]
+ *
+ * Returns 0 if every encode succeeded.
+ */
+UCLASS()
+class OPENCUEFORUNREALUTILS_API UOpenCueEncoderBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UOpenCueEncoderBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	/**
+	 * Write InNumFrames synthetic frames numbered like MRQ output ("Benchmark.0000.png") into InDirectory.
+	 * InFormat is png, jpg or bmp. Returns false if the format is unknown or a frame couldn't be written.
+	 */
+	static bool WriteSyntheticFrames(const FString& InDirectory, const int32 InWidth, const int32 InHeight, const int32 InNumFrames, const FString& InFormat,
+		TArray<FString>& OutFramePaths, int64& OutTotalBytes);
+};
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+
+/**
+ * Retry pacing for calls to a shared service such as the worker pool, so that hundreds of workers recovering from the
+ * same outage don't retry in lockstep.
+ *
+ * After a failure the next attempt waits a jittered exponential delay: half of min(Max, Base * 2^(n-1)) plus a random
+ * share of the other half, with the random stream seeded per process. After TripAfterFailures consecutive failures
+ * the circuit opens and no attempt is allowed for a jittered open period; then a single probe is let through,
+ * which closes the circuit on success or reopens it on failure. The open period starts at OpenDurationSec, raised to
+ * MaxDelaySec so that tripping never shortens the wait, and doubles after each failed probe up to four times that.
+ */
+class OPENCUEFORUNREALUTILS_API FOpenCueRetryBackoff
+{
+public:
+	FOpenCueRetryBackoff(double InBaseDelaySec = 1.0, double InMaxDelaySec = 60.0, int32 InTripAfterFailures = 8, double InOpenDurationSec = 60.0);
+
+	/** True if an attempt may be made now. Callers keep one attempt in flight, which makes the half-open probe a single one. */
+	bool CanAttempt(double InNow) const;
+
+	/** Report the outcome of an attempt. */
+	void OnSuccess();
+	void OnFailure(double InNow);
+
+	bool IsCircuitOpen() const { return bCircuitOpen; }
+	int32 GetConsecutiveFailures() const { return ConsecutiveFailures; }
+
+	/** Seconds until the next attempt is allowed, 0 if one may be made now. */
+	double GetRemainingDelay(double InNow) const { return FMath::Max(NextAttemptTime - InNow, 0.0); }
+
+	/** Lifetime counters, reported as metrics. */
+	int64 GetTotalFailures() const { return TotalFailures; }
+	int32 GetTotalTrips() const { return TotalTrips; }
+
+private:
+	double BaseDelaySec;
+	double MaxDelaySec;
+	int32 TripAfterFailures;
+	double OpenDurationSec;
+
+	/** Open period for the next trip or failed probe, grows from OpenDurationSec while the circuit stays open. */
+	double CurrentOpenDurationSec;
+
+	FRandomStream RandomStream;
+
+	int32 ConsecutiveFailures = 0;
+	double NextAttemptTime = 0.0;
+	bool bCircuitOpen = false;
+
+	int64 TotalFailures = 0;
+	int32 TotalTrips = 0;
+};
+
+// Delivery state of a completion notification that needs the server's acknowledgement
+struct FOpenCueCompletionAck
+{
+	bool bAcknowledged = false;
+	bool bNeedsResend = false;
+	int32 Attempts = 0;
+	double LastSendTime = 0.0;
+
+	void OnSent(double Now) { ++Attempts; LastSendTime = Now; bNeedsResend = false; }
+	bool ShouldResend(double Now, double RetryDelay, int32 MaxAttempts) const
+	{
+		return !bAcknowledged && bNeedsResend && Attempts < MaxAttempts && Now - LastSendTime >= RetryDelay;
+	}
+};
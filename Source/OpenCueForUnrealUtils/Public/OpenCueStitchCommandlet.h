@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "OpenCueStitchCommandlet.generated.h"
+
+/**
+ * Final task of a chunked render: stream-copies the fragments that every chunk task encoded
+ * (UMoviePipelineCustomEncoder::bEncodeAsChunk, -EncodeAsChunk on the command line executor) into the deliverable.
+ * Takes seconds since nothing is re-encoded except the audio.
+ *
+ *   UnrealEditor-Cmd <Project> -run=OpenCueStitch -nullrhi -unattended
+ *       -JobDir=<dir containing the <start>-<end> chunk dirs> [-Output=<dir>] [-Executable=<ffmpeg>]
+ *       [-AllowGaps] [-DeleteChunks]
+ *
+ * -Output defaults to -JobDir. Returns 0 if every file was stitched.
+ */
+UCLASS()
+class OPENCUEFORUNREALUTILS_API UOpenCueStitchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UOpenCueStitchCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+
+/** Per-request options for FOpenCueWorkerHttpClient. */
+struct FOpenCueHttpRequestOptions
+{
+	/** Seconds before the request is abandoned, 0 or less uses FOpenCueWorkerHttpClient::DefaultTimeoutSec. */
+	float TimeoutSec = 10.0f;
+
+	/**
+	 * Resend the request if the connection failed (e.g. the server reset a kept-alive connection). Unset means
+	 * GET/HEAD/PUT/DELETE are retried and POST is not; set it for POSTs that are safe to repeat such as heartbeats.
+	 */
+	TOptional<bool> bIdempotent;
+
+	/** Attempts after the first one for idempotent requests. */
+	int32 MaxRetries = 2;
+
+	/**
+	 * For snapshots such as progress: a queued request to the same URL that also has this set is replaced instead of
+	 * queueing another one, so a slow server only ever has the latest snapshot waiting. The replaced request's
+	 * completion delegate is not called. Only one of them is in flight at a time, so snapshots arrive in order.
+	 */
+	bool bCoalesce = false;
+
+	/** Queue ahead of everything not yet sent (behind earlier bSendFirst requests), e.g. completion notifications. */
+	bool bSendFirst = false;
+
+	/**
+	 * Requests with the same key share a queue, and so its connections, within their endpoint. Empty means the
+	 * endpoint's default queue. Lets one process stand in for several workers that would each have their own.
+	 */
+	FString QueueKey;
+};
+
+/**
+ * HTTP client for worker traffic to the worker pool and the MRQ server (heartbeats, leases, progress, completion).
+ *
+ * Requests to the same endpoint (scheme://host:port) share a queue with at most MaxInFlightPerEndpoint of them on the
+ * wire, so the HTTP module reuses a few kept-alive connections per endpoint instead of opening a new one (and paying
+ * TCP/TLS setup) for every call, while one stalled request can't hold up the others. Every request has a finite
+ * timeout. A connection the server has dropped in the meantime shows up as a failed request; idempotent requests are
+ * then resent transparently on a fresh connection. Long-polls go through SendExclusive so they don't take up a slot.
+ *
+ * Game thread only.
+ */
+class OPENCUEFORUNREALUTILS_API FOpenCueWorkerHttpClient
+{
+public:
+	/** Requests of one endpoint queue that may be on the wire at the same time. */
+	static constexpr int32 MaxInFlightPerEndpoint = 4;
+
+	/** Timeout for requests whose options don't set one. */
+	static constexpr float DefaultTimeoutSec = 30.0f;
+
+	/**
+	 * Queue a request behind the other requests for its endpoint, see bCoalesce and bSendFirst for exceptions. Body is
+	 * sent as application/json when not empty.
+	 */
+	static void Send(const FString& InVerb, const FString& InUrl, const FString& InBody,
+		FHttpRequestCompleteDelegate InOnComplete = FHttpRequestCompleteDelegate(),
+		const FOpenCueHttpRequestOptions& InOptions = FOpenCueHttpRequestOptions());
+
+	/**
+	 * Send right away on a connection of its own, for requests the server holds open (long-poll). Not retried.
+	 * The returned request can be cancelled.
+	 */
+	static FHttpRequestPtr SendExclusive(const FString& InVerb, const FString& InUrl, const FString& InBody,
+		FHttpRequestCompleteDelegate InOnComplete, const FOpenCueHttpRequestOptions& InOptions = FOpenCueHttpRequestOptions());
+
+	/**
+	 * Tick the HTTP module until every queued request completed or the timeout elapsed, e.g. before the process exits.
+	 * @return true if nothing is pending anymore.
+	 */
+	static bool Flush(double InTimeoutSeconds);
+
+	/** Number of queued or in-flight requests, exclusive requests not included. */
+	static int32 GetNumPending();
+
+	/** scheme://host:port of InUrl, the key requests are queued on. */
+	static FString GetEndpoint(const FString& InUrl);
+};
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Delegates/Delegate.h"
+
+class FJsonObject;
+
+/**
+ * Optional WebSocket that carries heartbeats, job state transitions and progress of a worker as one stream of small
+ * JSON records, instead of separate heartbeat and progress REST calls to the worker pool and the MRQ server.
+ *
+ * Records are delta encoded: {"t":"progress","seq":42,"job":"<id>","progress_percent":0.51} only holds the fields that
+ * changed since the previous record of the same type and job. The first record after (re)connecting carries every
+ * field and "full":true. Field names are those of the REST payloads so the server can map them one to one.
+ *
+ * Every Send* returns false while the channel is not connected; callers then use the REST call as before. A dropped
+ * channel reconnects with backoff on the next send. The server can push records the other way, e.g. {"t":"drain"}
+ * where a REST heartbeat response would have carried {"drain":true}. Game thread only.
+ */
+class OPENCUEFORUNREALUTILS_API FOpenCueWorkerStatusChannel
+{
+public:
+	/** Called on the game thread for every record the server sends, with its "t" field as the type. */
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnRecordReceived, const FString& /*Type*/, const TSharedRef<FJsonObject>& /*Record*/);
+
+	/** Open the channel (ws:// or wss://). ClientId identifies this process in the hello record. No-op if already open on InUrl. */
+	static void Connect(const FString& InUrl, const FString& InClientId);
+
+	static void Disconnect();
+
+	static bool IsConnected();
+
+	/** Liveness record; sent even if no field changed. */
+	static bool SendHeartbeat(const TSharedRef<FJsonObject>& InFields);
+
+	/** Job state transition, e.g. assigned/completed/failed. Terminal states drop the job's delta records. */
+	static bool SendState(const FString& InJobId, const FString& InState);
+
+	/** Progress of a job, with the fields of the REST progress payload. Nothing is sent if no field changed. */
+	static bool SendProgress(const FString& InJobId, const TSharedRef<FJsonObject>& InFields);
+
+	static FOnRecordReceived& OnRecordReceived();
+};